@@ -9,8 +9,10 @@
  * 
  */
 
+#include <string.h>
 #include "hardware/timer.h"
 #include "hardware/irq.h"
+#include "hardware/sync.h"
 #include "hardware/gpio.h"
 #include "pico/stdlib.h"
 #include "pico/multicore.h"
@@ -19,18 +21,11 @@
 #include "ep_application.h"
 #include "hal_main.h"
 
-#define ALARM_NUM 0
-#define ALARM_IRQ TIMER_IRQ_0
+#define RN52_RX_BUFFER_SIZE      384 /* Characters of lines waiting to be processed: a whole metadata reply */
+#define RN52_RX_MAX_LINES        12  /* Lines waiting to be processed */
 
-#define MAX_RN52_INPUTBUFF_LINES       10 /* Maximum lines for input buffer (data coming from rn52 through uart) */
-#define MAX_RN52_INPUTBUFF_CHARACTERS  50 /* Maximum characters for input buffer (data coming from rn52 through uart) */
-
-#define RN52_TIMEOUT_CLICKS_MS   20
-
-/* Expected replies from RN52 */
-static uint8_t qSent;
-static uint8_t trackMetadataSent;
-static uint8_t token_Receivedrn52Msg;
+#define RN52_TIMEOUT_CLICKS_MS   20 /* RN52 quiet for that long after AOK or metadata lines: AD reply is complete */
+#define RN52_RX_FIFO_LEVEL       2  /* RX interrupt at 1/2 FIFO (16 characters), RX timeout interrupt for the rest */
 
 /* Bluetooth RN52 command messages (V1.16) */
 static char rn52_cmd_volup[RN52_CMD_SIZE_VOLUP]   = {'A','V','+','\r'}; //  - Volume Up
@@ -41,67 +36,126 @@ static char rn52_cmd_plp[RN52_CMD_SIZE_PLP]       = {'A','P','\r'};     //  - Pl
 static char rn52_cmd_track[RN52_CMD_SIZE_TRACK]   = {'A','D','\r'};     //  - REquest track metadata
 static char rn52_cmd_q[RN52_CMD_SIZE_Q]           = {'Q','\r'};         //  - Querry info
 
-/* Bluetooth RN52 command messages (V1.16) */
+/* Bluetooth RN52 command messages (V1.16). Only queries are sent again without reply */
 static rn52_mcmdMsg allRN52_cmd[RN52_CMD_MAX] = {
-   {RN52_CMD_VOLUP,  &rn52_cmd_volup[0],  RN52_CMD_SIZE_VOLUP  },
-   {RN52_CMD_VOLDWN, &rn52_cmd_voldwn[0], RN52_CMD_SIZE_VOLDWN },
-   {RN52_CMD_NXT,    &rn52_cmd_nxt[0],    RN52_CMD_SIZE_NXT    },
-   {RN52_CMD_PRV,    &rn52_cmd_prv[0],    RN52_CMD_SIZE_PRV    },
-   {RN52_CMD_PLP,    &rn52_cmd_plp[0],    RN52_CMD_SIZE_PLP    },
-   {RN52_CMD_PLP,    &rn52_cmd_track[0],  RN52_CMD_SIZE_TRACK  },
-   {RN52_CMD_Q,      &rn52_cmd_q[0],      RN52_CMD_SIZE_Q      }
+   {RN52_CMD_VOLUP,  &rn52_cmd_volup[0],  RN52_CMD_SIZE_VOLUP,  RN52_REPLY_AOK,      200, 0 },
+   {RN52_CMD_VOLDWN, &rn52_cmd_voldwn[0], RN52_CMD_SIZE_VOLDWN, RN52_REPLY_AOK,      200, 0 },
+   {RN52_CMD_NXT,    &rn52_cmd_nxt[0],    RN52_CMD_SIZE_NXT,    RN52_REPLY_AOK,      200, 0 },
+   {RN52_CMD_PRV,    &rn52_cmd_prv[0],    RN52_CMD_SIZE_PRV,    RN52_REPLY_AOK,      200, 0 },
+   {RN52_CMD_PLP,    &rn52_cmd_plp[0],    RN52_CMD_SIZE_PLP,    RN52_REPLY_AOK,      200, 0 },
+   {RN52_CMD_TRACK,  &rn52_cmd_track[0],  RN52_CMD_SIZE_TRACK,  RN52_REPLY_METADATA, 500, 2 },
+   {RN52_CMD_Q,      &rn52_cmd_q[0],      RN52_CMD_SIZE_Q,      RN52_REPLY_STATUS,   200, 2 }
 };
 
 /**
- * @brief save characters coming from rn52's uart. Save them in a buffer.
- * As this data comes with \r characters in it, use it to save a new line
- * Or if data line received is too long for MAX_RN52_INPUTBUFF_CHARACTERS,
- * add a line break
+ * @brief Command sent, waiting for its reply
+ */
+typedef struct {
+   RN52_CMD_ID _cmd;
+   uint32_t    _sentMs;
+   uint8_t     _tries;      /* Times sent */
+   bool        _active;     /* false: nothing waiting for a reply */
+   bool        _metadata;   /* Metadata fields received, screen to be flushed */
+   bool        _replied;    /* At least one line received for this command (AOK or fields) */
+} rn52_pendingCmd;
+
+/* Commands queued by bt_sendCommand(), main loop only */
+static RN52_CMD_ID      _txQueue[RN52_TX_QUEUE_SIZE];
+static uint8_t          _txHead;
+static uint8_t          _txTail;
+static rn52_pendingCmd  _pending;
+static volatile bool    _statusRequested;   /* Set by GPIO2 interrupt */
+
+/**
+ * @brief One line received from RN52, in place in receive buffer: no copy.
+ * Text is '\0' terminated, its '\n' was replaced.
+ */
+typedef struct {
+   char    *_text;
+   uint16_t _size;   /* Without '\0' */
+} rn52_line;
+
+/**
+ * @brief save characters coming from rn52's uart. Lines are stored one after
+ * the other, '\0' terminated, and the end of each one is indexed. Processed
+ * lines are consumed at once (rn52_consumeLines), buffer starts again from its
+ * beginning: a line never wraps, whatever its length.
+ * One character is always kept free for the '\0' of actual line.
  */
-char rn52_inputBuffer[MAX_RN52_INPUTBUFF_LINES][MAX_RN52_INPUTBUFF_CHARACTERS];
+static char              _rxBuffer[RN52_RX_BUFFER_SIZE];
+static volatile uint16_t _rxSize;                         /* Characters used in _rxBuffer */
+static uint16_t          _lineEnds[RN52_RX_MAX_LINES];    /* Offset of '\0' of each complete line */
+static volatile uint8_t  _lineCount;                      /* Complete lines in _rxBuffer */
+static volatile uint32_t _rxDropped;                      /* Characters dropped, buffer full */
 
 /**
  * @brief Receive RX on bluetooth's module UART
  */
 static void bt_irqUartRx(void);
 
+/**
+ * @brief Save one character received from RN52 into input buffer
+ * @return true if it ended a line
+ */
+static bool bt_storeChar(uint8_t ch);
+
 static void rn52_processReply(void);
 
-static void rn52_processQReply(void);
+/**
+ * @brief Give one line received to command waiting for a reply
+ */
+static void rn52_routeLine(rn52_line *line);
 
-static void rn52_processADReply(uint8_t line);
+/**
+ * @brief Reply complete, timeouts and retries of pending command, then send
+ * next queued one
+ */
+static void rn52_processCommand(uint32_t nowMs);
 
-static void rn52_cmdProcessed(void);
+/**
+ * @brief Pending command finished, with its reply or without
+ */
+static void rn52_cmdDone(void);
 
-static uint8_t convertToHex(char character);
+/**
+ * @brief Write a command to RN52. TX FIFO holds it whole, as only one command
+ * is sent at once: it does not wait
+ */
+static void rn52_write(RN52_CMD_ID rn52cmd);
+
+static void rn52_processQReply(const rn52_line *line);
+
+/**
+ * @brief Show one field of track metadata, like "Title=Veterstift"
+ * @return true if line is a metadata field shown on screen
+ */
+static bool rn52_processADReply(rn52_line *line);
 
-int64_t alarm_callback_rn52(alarm_id_t id, void *user_data);
+/**
+ * @brief Get a complete line received, in place
+ * @return true if line exists
+ */
+static bool rn52_getLine(uint8_t index, rn52_line *line);
 
-static void rn52_dropLine(uint8_t lineToDrop);
+/**
+ * @brief Check beginning of a line
+ */
+static bool rn52_lineStartsWith(const rn52_line *line, const char *prefix);
 
 /**
- * @brief elements for state machine to process command send and answer process from rn52
+ * @brief Free first lines of receive buffer, once processed
  */
-static uint8_t _indexLine;
-static uint8_t _indexChar;
+static void rn52_consumeLines(uint8_t lines);
 
-/* RE timeout between clicks. If fired, cancel actual rotation calculation */
-static alarm_id_t currentAlarm_rn52;
-static bool       _eventToProcess;
+static uint8_t convertToHex(char character);
 
-int64_t alarm_callback_rn52(alarm_id_t id, void *user_data)
-{
-   currentAlarm_rn52 = 0x00;
-   _eventToProcess = true;
-   return 0;
-}
+/* Lines received, routed at next bt_processInputs() */
+static volatile bool     _eventToProcess;
+/* Time of last characters, end of AD metadata reply is detected with it */
+static volatile uint32_t _lastRxMs;
 
 void bt_init(void)
 {
-   qSent = 0x00;
-   trackMetadataSent = 0x00;
-   token_Receivedrn52Msg = 0x00;
-   
    // Set up our UART with a basic baud rate.
    uart_init(BT_UART_ID, BT_UART_BAUDRATE);
 
@@ -116,8 +170,8 @@ void bt_init(void)
    // Set our data format
    uart_set_format(BT_UART_ID, BT_UART_DATABITS, BT_UART_STOPBITS, BT_UART_PARITY);
 
-   // Turn off FIFO's - we want to do this character by character
-   uart_set_fifo_enabled(BT_UART_ID, false);
+   // FIFO on: one interrupt per 16 characters, or once line is idle (RX timeout)
+   uart_set_fifo_enabled(BT_UART_ID, true);
 
    // Set up a RX interrupt
    // We need to set up the handler first
@@ -128,14 +182,24 @@ void bt_init(void)
    irq_set_exclusive_handler(UART_IRQ, bt_irqUartRx);
    irq_set_enabled(UART_IRQ, true);
 
-   // Now enable the UART to send interrupts - RX only
+   // Now enable the UART to send interrupts - RX and RX timeout only.
+   // SDK sets RX level to its minimum, raise it: RX timeout flushes short replies
    uart_set_irq_enables(BT_UART_ID, true, false);
+   hw_write_masked(&uart_get_hw(BT_UART_ID)->ifls, RN52_RX_FIFO_LEVEL << UART_UARTIFLS_RXIFLSEL_LSB,
+                   UART_UARTIFLS_RXIFLSEL_BITS);
 
-   _indexLine = 0x00;
-   _indexChar = 0x00;
+   _rxSize    = 0x00;
+   _lineCount = 0x00;
+   _rxDropped = 0x00;
    _eventToProcess = false;
+   _lastRxMs = 0x00;
 
-   currentAlarm_rn52 = (alarm_id_t)0x00;
+   _txHead = 0x00;
+   _txTail = 0x00;
+   _pending._active   = false;
+   _pending._metadata = false;
+   _pending._replied  = false;
+   _statusRequested   = false;
 
    printf("[BT][API] Init BT done\n");
 }
@@ -161,23 +225,27 @@ void bt_sendCommand(RN52_CMD_ID rn52cmd)
       /* Not a reckognized command */
       printf("[BT][ERROR] wrong RN52 command 0x%2x\n", (uint8_t)rn52cmd);
    }
+   else if(RN52_TX_QUEUE_SIZE <= (uint8_t)(_txHead - _txTail))
+   {
+      /* Encoder turned faster than RN52 replies */
+      printf("[BT][ERROR] command queue full, 0x%2x dropped\n", (uint8_t)rn52cmd);
+   }
    else
    {
-      uart_write_blocking(BT_UART_ID, (uint8_t*) allRN52_cmd[rn52cmd].msgPtr, allRN52_cmd[rn52cmd].msgSize);
+      _txQueue[_txHead % RN52_TX_QUEUE_SIZE] = rn52cmd;
+      _txHead++;
    }
 }
 
 /**
- * @brief In case of GPIO2 triggered, send Q cmd and process reply
+ * @brief In case of GPIO2 triggered, ask for Q cmd. Interrupt context: it is
+ * queued by main loop
  * 
  */
 void rn52_handleGpio2(void)
 {
 //   printf("[BT][API]GPIO 2 IRQ\n");
-   /* Wait 10 ms before asking what happened */
-   /* send Q to RN52 module */
-   bt_sendCommand(RN52_CMD_Q);
-   currentAlarm_rn52 = add_alarm_in_ms(RN52_TIMEOUT_CLICKS_MS, alarm_callback_rn52, NULL, false);
+   _statusRequested = true;
 }
 
 /**
@@ -186,131 +254,234 @@ void rn52_handleGpio2(void)
  */
 void bt_processInputs(void)
 {
+   /* RN52 notified an event: ask what happened */
+   if(true == _statusRequested)
+   {
+      _statusRequested = false;
+      bt_sendCommand(RN52_CMD_Q);
+   }
+
+   /* Each line goes to command waiting for it. Flag is cleared first,
+    * lines received meanwhile are processed next time */
    if(true == _eventToProcess)
    {
-      rn52_processReply();
       _eventToProcess = false;
+      rn52_processReply();
    }
+
+   rn52_processCommand(to_ms_since_boot(get_absolute_time()));
 }
 
 //////////////////// Bluetooth and rn52 specific functions (statics) ////////////////////
 
 /**
- * @brief UART IRQ for one character coming from RN52.
+ * @brief UART IRQ (RX FIFO level or RX timeout) for characters coming from
+ * RN52. FIFO is drained at once: cost is per message, not per character.
  * RN52 sends reply as string of characters ended by a '\r'
  * character.
  * Sometimes it is one hexadecimal line, sometimes strings
  * of ASCII chars on many lines, all ended by '\r'.
  * 
  * As the aim is to process this data peacefully, save it first
- * in a temporar buffer.
- * As soon as a '\r' char is received, fire a timer of 10 ms to
- * wait if there are no other chars coming.
- * If IRQ called again while timer runs, kill timer
- * 
- * Received messages from RN52 is sometimes polluted with \r and \n 
- * characters, which do disturb getting distincts answers.
- * If one of them is received, drop it.
- * \r = 13
- * \n = 10
+ * in a temporar buffer. bt_processInputs() routes complete lines as soon
+ * as it runs. Time of last characters is saved: only AD metadata reply,
+ * which has no end line, waits for RN52_TIMEOUT_CLICKS_MS of silence.
  */
 static void bt_irqUartRx(void) 
 {
-   uint8_t ch = uart_getc(BT_UART_ID);
-#if 0
-   if(('\r' == ch) || ('\n' == ch))
+   bool lineEnded = false;
+
+   while(true == uart_is_readable(BT_UART_ID))
    {
-      printf("\\%d", (uint8_t)ch);
+      lineEnded |= bt_storeChar((uint8_t)uart_getc(BT_UART_ID));
    }
-   else
+
+   _lastRxMs = to_ms_since_boot(get_absolute_time());
+   if(true == lineEnded)
    {
-      printf("%c", ch);
+      _eventToProcess = true;
    }
-#endif
-#if 1
+}
+
+/**
+ * Received messages from RN52 is sometimes polluted with \r and \n 
+ * characters, which do disturb getting distincts answers.
+ * If one of them is received, drop it.
+ * \r = 13
+ * \n = 10
+ */
+static bool bt_storeChar(uint8_t ch)
+{
+   bool retVal = false;
+
    /* If \r char, drop it as it pollutes communication. 
    It is sometimes received two or 3 times per line */
    if(('\r' != ch)
-    &&(0x00 != (uint8_t)ch))
+    &&(0x00 != ch))
    {
-      /* New character, cancel timer if activated */
-      if(0x00 != currentAlarm_rn52)
+      /* End of line: look only at \n chars, as \r may be received multiple
+      times for one reply line. Its place is always free */
+      if(('\n' == ch) && (RN52_RX_MAX_LINES > _lineCount))
       {
-         cancel_alarm(currentAlarm_rn52);
+         _rxBuffer[_rxSize]     = '\0';
+         _lineEnds[_lineCount]  = _rxSize;
+         _rxSize++;
+         _lineCount++;
+         retVal = true;
       }
-
-      /* Save reply only if we are awaiting for one */
-      if(MAX_RN52_INPUTBUFF_LINES > _indexLine)
+      else if(('\n' != ch) && ((RN52_RX_BUFFER_SIZE - 1) > _rxSize))
       {
-         if(MAX_RN52_INPUTBUFF_CHARACTERS > _indexChar)
-         {
-            rn52_inputBuffer[_indexLine][_indexChar] = ch;
-            _indexChar++;
-         }
-
-         /* New line if too many characters for input buffer or \n char received
-         look only at \n chars, as \r may be received multiple times for one reply line */
-         if((MAX_RN52_INPUTBUFF_CHARACTERS == _indexChar) || ('\n' == ch))
-         {
-            /* Prepare new line in case of other characters are coming */
-            _indexLine++;
-            _indexChar = 0x00;
-            /* Fire alarm to process received reply */
-            currentAlarm_rn52 = add_alarm_in_ms(RN52_TIMEOUT_CLICKS_MS, alarm_callback_rn52, NULL, false);
-         }
+         _rxBuffer[_rxSize] = (char)ch;
+         _rxSize++;
       }
       else
       {
-         /* Loo buffer */
-         _indexLine = 0x00;
+         /* Buffer full: counted, never wrapped over lines not processed yet */
+         _rxDropped++;
       }
    }
-#endif   
+   return retVal;
 }
 
 /**
- * @brief Called by timer, which means one or many characters were received
- * and that we are currently in a peaceful moment (no new characters since 
- * RN52_TIMEOUT_CLICKS_MS ms)
+ * @brief Called by bt_processInputs() once one or many lines were received.
+ * Each line is routed right away to the command waiting for it, no quiet
+ * time is needed. Only AD metadata completion waits for RN52 to be quiet,
+ * see rn52_processCommand().
  */
 static void rn52_processReply(void)
 {
-   uint8_t index = 0x00;
-   /* drop polluting lines */
-   for(index = 0; index < MAX_RN52_INPUTBUFF_LINES; index++)
+   rn52_line line;
+   uint8_t   lines    = _lineCount;   /* Lines received later are processed next time */
+   uint8_t   index    = 0x00;
+
+   if(0x00 != _rxDropped)
+   {
+      printf("[BT][DBG] %lu characters dropped, receive buffer full\n", (unsigned long)_rxDropped);
+      _rxDropped = 0x00;
+   }
+
+   for(index = 0; (index < lines) && (true == rn52_getLine(index, &line)); index++)
    {
-      /* Process what kind of reply we had. Horrible way but RN52 sends sometimes random replies */
-      if (('A' == rn52_inputBuffer[index][0])
-       && ('O' == rn52_inputBuffer[index][1])
-       && ('K' == rn52_inputBuffer[index][2]))
+      rn52_routeLine(&line);
+   }
+   rn52_consumeLines(lines);
+}
+
+static void rn52_routeLine(rn52_line *line)
+{
+   bool handled = false;
+
+   if(true == _pending._active)
+   {
+      switch(allRN52_cmd[_pending._cmd].reply)
       {
-         rn52_dropLine(index);
+         case RN52_REPLY_AOK:
+            /* AOK is replied by all AV/AT/AP commands, like next track, play pause, etc... */
+            handled = (true == rn52_lineStartsWith(line, "AOK")) || (true == rn52_lineStartsWith(line, "ERR"));
+            if(true == rn52_lineStartsWith(line, "ERR"))
+            {
+               printf("[BT][ERROR] RN52 refused command 0x%2x\n", (uint8_t)_pending._cmd);
+            }
+            break;
+         case RN52_REPLY_STATUS:
+            /* Reply to Q is something like "XXXX" where X are hexadecimal numbers */
+            if(4 == line->_size)
+            {
+               rn52_processQReply(line);
+               handled = true;
+            }
+            break;
+         case RN52_REPLY_METADATA:
+            /* Fields come one line each, in any order, AOK may come before
+             * them: completion is only decided by rn52_processCommand() */
+            if(true == rn52_processADReply(line))
+            {
+               _pending._metadata = true;
+               _pending._replied  = true;
+            }
+            else if(true == rn52_lineStartsWith(line, "AOK"))
+            {
+               _pending._replied  = true;
+            }
+            break;
+         default:
+            break;
       }
-      else
+   }
+
+   if(true == handled)
+   {
+      rn52_cmdDone();
+   }
+   else if((false == _pending._active) || (RN52_REPLY_METADATA != allRN52_cmd[_pending._cmd].reply))
+   {
+      /* Late reply of a command given up, or RN52 talking by itself */
+      printf("[BT][DBG] Unexpected reply: %s\n", line->_text);
+   }
+}
+
+static void rn52_processCommand(uint32_t nowMs)
+{
+   const rn52_mcmdMsg *cmd = &allRN52_cmd[_pending._cmd];
+
+   if(true == _pending._active)
+   {
+      if((RN52_REPLY_METADATA == cmd->reply) && (true == _pending._replied)
+      && ((nowMs - _lastRxMs) >= RN52_TIMEOUT_CLICKS_MS))
+      {
+         /* RN52 quiet after AOK or metadata lines: reply complete */
+         rn52_cmdDone();
+      }
+      else if((nowMs - _pending._sentMs) >= cmd->timeoutMs)
       {
-         if (('T' == rn52_inputBuffer[index][0])
-          && ('i' == rn52_inputBuffer[index][1])
-          && ('t' == rn52_inputBuffer[index][2])
-          && ('l' == rn52_inputBuffer[index][3])
-          && ('e' == rn52_inputBuffer[index][4])
-          && ('=' == rn52_inputBuffer[index][5]))
+         if(_pending._tries <= cmd->retries)
          {
-            rn52_processADReply(index);
+            printf("[BT][DBG] No reply to command 0x%2x, sent again\n", (uint8_t)_pending._cmd);
+            rn52_write(_pending._cmd);
+            _pending._sentMs = nowMs;
+            _pending._tries++;
          }
-
-         /* Check that reply is not "AOK\r", but something like "XXXX\r" where X are hexadecimal numbers
-          * AOK is replied by all AD/AV commands, like next track, play pause, etc... 
-          */
-         if ('\n'== rn52_inputBuffer[index][4])
+         else
          {
-            /* Check if it is an AOK from RN52 (then discard) */
-            rn52_processQReply();
+            printf("[BT][ERROR] No reply to command 0x%2x, given up\n", (uint8_t)_pending._cmd);
+            rn52_cmdDone();
          }
       }
    }
+
+   /* Commands are pipelined in order: next one as soon as previous is replied */
+   if((false == _pending._active) && (_txHead != _txTail))
+   {
+      _pending._cmd      = _txQueue[_txTail % RN52_TX_QUEUE_SIZE];
+      _pending._sentMs   = nowMs;
+      _pending._tries    = 0x01;
+      _pending._metadata = false;
+      _pending._replied  = false;
+      _pending._active   = true;
+      _txTail++;
+      rn52_write(_pending._cmd);
+   }
 }
 
-static void rn52_processQReply(void)
+static void rn52_cmdDone(void)
+{
+   /* Write down to display */
+   if(true == _pending._metadata)
+   {
+      ep_flush();
+   }
+   _pending._metadata = false;
+   _pending._replied  = false;
+   _pending._active   = false;
+}
+
+static void rn52_write(RN52_CMD_ID rn52cmd)
+{
+   uart_write_blocking(BT_UART_ID, (uint8_t*) allRN52_cmd[rn52cmd].msgPtr, allRN52_cmd[rn52cmd].msgSize);
+}
+
+static void rn52_processQReply(const rn52_line *line)
 {
    /* Convert values first */
    uint8_t byte0low  = 0x00;
@@ -319,8 +490,8 @@ static void rn52_processQReply(void)
 
    uint8_t connectionStatus  = 0x00;
 
-   byte0low  = convertToHex(rn52_inputBuffer[0][3]);
-   byte0high = convertToHex(rn52_inputBuffer[0][2]) << 1;
+   byte0low  = convertToHex(line->_text[3]);
+   byte0high = convertToHex(line->_text[2]) << 1;
 
    resultByte0 = byte0high | byte0low;
    printf("[BT][DBG] Q received = 0x%2x\n", resultByte0);
@@ -330,14 +501,8 @@ static void rn52_processQReply(void)
    {
       printf("[BT][CMD] Track change notification\n");
 
-      /* Data processed, clean input buffer from RN52 */
-      rn52_cmdProcessed();
-
-      /* Send new cmd: ask what happened */
+      /* Send new cmd: ask what happened, answer processed once received */
       bt_sendCommand(RN52_CMD_TRACK);  
-
-      /* Let time before processing answer */
-      currentAlarm_rn52 = add_alarm_in_ms(RN52_TIMEOUT_CLICKS_MS, alarm_callback_rn52, NULL, false);
    }
 
    /* Other kind of reply could be processed here depending on Q reply (like "new connection")*/
@@ -349,97 +514,80 @@ static void rn52_processQReply(void)
 
 }
 
-/**
- * @brief 
- * @optimisation: change copy of values to a shifted pointer of 6 oder 7 chars
- * @param line 
- */
-static void rn52_processADReply(uint8_t line)
+static bool rn52_processADReply(rn52_line *line)
 {
-   printf("[BT][DBG] Process track change at line %d\n", line);
-   /* Kind of reply we may have when asking for track metadata:
+   /* Kind of reply we may have when asking for track metadata, in any order:
     *  Title=Veterstift
     *  Artist=Hush
     *  Album=Ruimtevaart EP
     */
-   uint8_t index     = 0x00;
-   uint8_t indexChar = 0x00;
-   uint8_t track[EPAPER_CHARS_PER_LINE];  /* Max EP characters per line */
-   uint8_t artist[EPAPER_CHARS_PER_LINE]; /* Max EP characters per line */
-   uint8_t Album[EPAPER_CHARS_PER_LINE]; /* Max EP characters per line */
-
-   for(index = 0; index < EPAPER_CHARS_PER_LINE; index++)
-   {
-      track[index]  = 0x00;
-      artist[index] = 0x00;
-      Album[index]  = 0x00;
-   }
-
-   /* ==================== PRINT TITLE ==================== */
-   /* Drop all 0x00 if exists */
-   /* +6 is for "Title=" character offset which we don't require */
-   do {
-      track[indexChar] = rn52_inputBuffer[line][indexChar+6];
-      indexChar++;
-   }
-   while(('\n' != rn52_inputBuffer[line][indexChar+6])
-    && (EPAPER_CHARS_PER_LINE > (indexChar+6)));
-
-   ep_write(EPAPER_PLACE_BT_TRACK, 1, (char *)&track[0], false);
-
-
-   /* ==================== PRINT ARTIST ==================== */
-   /* +7 is for "Artist=" character offset which we don't require */
-   indexChar = 0x00;
-   while(('\n' != rn52_inputBuffer[line+1][indexChar+7])
-    &&   (EPAPER_CHARS_PER_LINE > (indexChar+7)))
+   static const struct {
+      const char *_prefix;
+      uint8_t     _screenLine;
+   } fields[] = {{"Title=", 1}, {"Artist=", 3}, {"Album=", 5}};
+   uint8_t index  = 0x00;
+   uint8_t size   = 0x00;
+   bool    retVal = false;
+
+   for(index = 0; (index < (sizeof(fields) / sizeof(fields[0]))) && (false == retVal); index++)
    {
-      artist[indexChar] = rn52_inputBuffer[line+1][indexChar+7];
-      indexChar++;
+      if(true == rn52_lineStartsWith(line, fields[index]._prefix))
+      {
+         /* Value is shown in place. Whole value in logs, screen line is shorter */
+         size = (uint8_t)strlen(fields[index]._prefix);
+         printf("[BT][DBG] %s\n", line->_text);
+         if((size + EPAPER_CHARS_PER_LINE - 1) < line->_size)
+         {
+            line->_text[size + EPAPER_CHARS_PER_LINE - 1] = '\0';
+         }
+         ep_write(EPAPER_PLACE_BT_TRACK, fields[index]._screenLine, &line->_text[size], false);
+         retVal = true;
+      }
    }
-   ep_write(EPAPER_PLACE_BT_TRACK, 3, (char *)&artist[0], false);
+   return retVal;
+}
 
+static bool rn52_getLine(uint8_t index, rn52_line *line)
+{
+   uint16_t start  = (0 < index) ? (uint16_t)(_lineEnds[index - 1] + 1) : 0x00;
+   bool     retVal = (index < _lineCount);
 
-   /* ==================== PRINT ALBUM ==================== */
-   /* +6 is for "Album=" character offset which we don't require */
-   indexChar = 0x00;
-   while(('\n' != rn52_inputBuffer[line+2][indexChar+6])
-    &&   (EPAPER_CHARS_PER_LINE > (indexChar+6)))
+   if(true == retVal)
    {
-      Album[indexChar] = rn52_inputBuffer[line+2][indexChar+6];
-      indexChar++;
+      line->_text = &_rxBuffer[start];
+      line->_size = (uint16_t)(_lineEnds[index] - start);
    }
-   ep_write(EPAPER_PLACE_BT_TRACK, 5, (char *)&Album[0], false);
-
-   /* Write down to display */
-   ep_flush();
-
-   /* Finished with cmd process */
-   rn52_cmdProcessed();
+   return retVal;
 }
 
-static void rn52_cmdProcessed(void)
+static bool rn52_lineStartsWith(const rn52_line *line, const char *prefix)
 {
-   uint8_t indexLines = 0x00;
+   size_t size = strlen(prefix);
 
-   /* Reset input buffer */
-   for(indexLines = 0x00; indexLines < MAX_RN52_INPUTBUFF_LINES; indexLines++)
-   {
-      rn52_dropLine(indexLines);
-   }
-   _indexLine = 0x00;
-   _indexChar = 0x00;
+   return ((size <= line->_size) && (0 == memcmp(line->_text, prefix, size)));
 }
 
-static void rn52_dropLine(uint8_t lineToDrop)
+static void rn52_consumeLines(uint8_t lines)
 {
-   printf("[BT][DBG] clean line\n");
-   uint8_t indexChar = 0x00;
-   for(indexChar = 0x00; indexChar < MAX_RN52_INPUTBUFF_CHARACTERS; indexChar++)
+   uint16_t used     = 0x00;
+   uint8_t  index    = 0x00;
+   uint32_t irqState = 0x00;
+
+   if(0 < lines)
    {
-      rn52_inputBuffer[lineToDrop][indexChar] = 0x00;
+      /* UART interrupt may add characters meanwhile. Most of the time nothing
+       * was received since processing started: nothing to move */
+      irqState = save_and_disable_interrupts();
+      used     = (uint16_t)(_lineEnds[lines - 1] + 1);
+      memmove(&_rxBuffer[0], &_rxBuffer[used], _rxSize - used);
+      for(index = lines; index < _lineCount; index++)
+      {
+         _lineEnds[index - lines] = (uint16_t)(_lineEnds[index] - used);
+      }
+      _rxSize    = (uint16_t)(_rxSize - used);
+      _lineCount = (uint8_t)(_lineCount - lines);
+      restore_interrupts(irqState);
    }
-   _indexChar = 0x00;
 }
 
 /**
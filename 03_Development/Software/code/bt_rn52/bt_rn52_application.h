@@ -41,6 +41,8 @@
 #define RN52_QREPLY_TRACK_POS 5
 #define RN52_QREPLY_CONNMASK  0x0F
 
+#define RN52_TX_QUEUE_SIZE    8  /* Commands waiting for previous ones to be replied */
+
 typedef enum {
    RN52_CMD_VOLUP = 0,
    RN52_CMD_VOLDWN,
@@ -53,10 +55,20 @@ typedef enum {
    RN52_CMD_MAX
 } RN52_CMD_ID;
 
+/* Reply expected from RN52 after a command */
+typedef enum {
+   RN52_REPLY_AOK = 0,   /* "AOK" line, or "ERR" */
+   RN52_REPLY_STATUS,    /* Reply to Q: 4 hexadecimal characters */
+   RN52_REPLY_METADATA   /* Reply to AD: "Field=value" lines, complete once RN52 is quiet */
+} RN52_REPLY;
+
 typedef struct {
    RN52_CMD_ID cmdId;
    char*       msgPtr;
    uint8_t     msgSize;
+   RN52_REPLY  reply;       /* Reply expected, routed to this command */
+   uint16_t    timeoutMs;   /* Without reply after that, sent again or given up */
+   uint8_t     retries;     /* Times sent again at most. 0 if doubling it would be wrong (volume, track...) */
 } rn52_mcmdMsg;
 
 /**
@@ -68,7 +80,9 @@ void bt_deactivate(void);
 void bt_activate(void);
 
 /**
- * @brief send an RN52 command to bluetooth module
+ * @brief queue an RN52 command for bluetooth module. Commands are sent in
+ * order, each one once previous got its reply, by bt_processInputs(): never
+ * blocks. Not to be called from an interrupt.
  * 
  * @param rn52cmd [in] command defined in enum RN52_CMD_ID
  */
@@ -82,7 +96,8 @@ void bt_sendCommand(RN52_CMD_ID rn52cmd);
 void bt_processInputs(void);
 
 /**
- * @brief Handle notification interrupt from RN52 module
+ * @brief Handle notification interrupt from RN52 module: status (Q) is
+ * requested by next bt_processInputs()
  */
 void rn52_handleGpio2(void);
 
@@ -0,0 +1,211 @@
+/**
+ * @file    si470x_afSwitch.c
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Automatic switch to an alternative frequency. See si470x_afSwitch.h
+ *
+ *          Si4703 has only one tuner: an AF can't be measured while listening
+ *          to another one. Each check is a blocking tune polling STC (no wait
+ *          for GPIO2) with audio muted, and only FM_AF_MAX_CHECKS of them
+ *          are done per attempt. Next attempt starts with following AF.
+ * @version 0.1
+ * @date    2023-09-11
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "pico/stdlib.h"
+#include "si470x_afSwitch.h"
+#include "si470x_rdsService.h"
+#include "si470x_rdsRing.h"
+#include "si470x_rdsGate.h"
+#include "rdsCache.h"
+
+static fm_afSwitch_monitor _monitor;
+
+/**
+ * @brief Average of RSSI history
+ */
+static uint8_t fm_afSwitch_averageRSSI(void);
+
+/**
+ * @brief Measure some AF of a programme and switch to the best one, if better
+ * than actual frequency
+ */
+static void fm_afSwitch_tryAF(uint16_t pi, uint8_t actualRssi);
+
+/**
+ * @brief Go back to frequency listened before switch
+ */
+static void fm_afSwitch_revert(void);
+
+void fm_afSwitch_init(void)
+{
+   _monitor._nextAF = 0x00;
+   _monitor._verifyPI = RDS_CACHE_PI_UNKNOWN;
+   fm_afSwitch_newStation();
+}
+
+void fm_afSwitch_newStation(void)
+{
+   /* User changed station in the middle of a switch, give audio back */
+   if(RDS_CACHE_PI_UNKNOWN != _monitor._verifyPI)
+   {
+      si470x_setMute(_monitor._wasMuted);
+   }
+
+   _monitor._rssiIndex     = 0x00;
+   _monitor._rssiSamples   = 0x00;
+   _monitor._verifyPI      = RDS_CACHE_PI_UNKNOWN;
+   _monitor._lastSampleMs  = to_ms_since_boot(get_absolute_time());
+   _monitor._lastAttemptMs = _monitor._lastSampleMs - FM_AF_HOLDOFF_MS;
+}
+
+void fm_afSwitch_process(uint16_t pi)
+{
+   uint32_t nowMs   = to_ms_since_boot(get_absolute_time());
+   uint8_t  average = 0x00;
+
+   if(RDS_CACHE_PI_UNKNOWN != _monitor._verifyPI)
+   {
+      /* No RDS on new AF, or no PI received in time */
+      if(FM_AF_PI_TIMEOUT_MS <= (nowMs - _monitor._verifyStartMs))
+      {
+         printf("[FM][AF] No PI on AF, go back\n");
+         fm_afSwitch_revert();
+      }
+   }
+   else if(FM_AF_RSSI_PERIOD_MS <= (nowMs - _monitor._lastSampleMs))
+   {
+      _monitor._lastSampleMs = nowMs;
+      _monitor._rssiHistory[_monitor._rssiIndex] = si470x_getRSSI();
+      _monitor._rssiIndex = (_monitor._rssiIndex + 1) % FM_AF_RSSI_HISTORY;
+      if(FM_AF_RSSI_HISTORY > _monitor._rssiSamples)
+      {
+         _monitor._rssiSamples++;
+      }
+
+      average = fm_afSwitch_averageRSSI();
+      if((FM_AF_RSSI_HISTORY == _monitor._rssiSamples)
+      && (FM_AF_WEAK_RSSI > average)
+      && (RDS_CACHE_PI_UNKNOWN != pi)
+      && (FM_AF_HOLDOFF_MS <= (nowMs - _monitor._lastAttemptMs)))
+      {
+         _monitor._lastAttemptMs = nowMs;
+         fm_afSwitch_tryAF(pi, average);
+      }
+   }
+}
+
+bool fm_afSwitch_rdsGroup(uint16_t pi, uint8_t station)
+{
+   bool retVal = false;
+
+   if((RDS_CACHE_PI_UNKNOWN != _monitor._verifyPI) && (RDS_CACHE_PI_UNKNOWN != pi)
+   && (_monitor._verifyStation == station))
+   {
+      if(_monitor._verifyPI == pi)
+      {
+         /* Same programme on new AF, end of switch */
+         printf("[FM][AF] Switched to %f\n", si470x_getFrequency());
+         si470x_setMute(_monitor._wasMuted);
+         _monitor._verifyPI    = RDS_CACHE_PI_UNKNOWN;
+         _monitor._rssiSamples = 0x00;
+         retVal = true;
+      }
+      else
+      {
+         /* Another programme broadcasted on this frequency here */
+         printf("[FM][AF] PI 0x%04x on AF instead of 0x%04x, go back\n", pi, _monitor._verifyPI);
+         fm_afSwitch_revert();
+      }
+   }
+   return retVal;
+}
+
+static void fm_afSwitch_tryAF(uint16_t pi, uint8_t actualRssi)
+{
+   uint8_t afList[AF_MAX_FREQS];
+   uint8_t afCount  = rdsCache_getAF(pi, &afList[0]);
+   uint8_t checks   = 0x00;
+   uint8_t rssi     = 0x00;
+   uint8_t bestRssi = 0x00;
+   float   bestFreq = 0.0f;
+   float   freq     = 0.0f;
+
+   if(0 < afCount)
+   {
+      printf("[FM][AF] Weak signal (%d dBuV), check AF of PI 0x%04x\n", actualRssi, pi);
+      _monitor._originalFreq = si470x_getFrequency();
+      _monitor._wasMuted     = si470x_getMute();
+      si470x_setMute(true);
+      /* Groups of other frequencies must not be captured while they are checked */
+      fm_rdsRing_enable(false);
+
+      for(checks = 0; (checks < FM_AF_MAX_CHECKS) && (checks < afCount); checks++)
+      {
+         freq = AF_CODE_TO_MHZ(afList[(_monitor._nextAF + checks) % afCount]);
+
+         /* Actual frequency is often part of the list */
+         if(0.05f < fabsf(freq - _monitor._originalFreq))
+         {
+            rssi = si470x_tuneFrequencyBlocking(freq);
+            if(rssi > bestRssi)
+            {
+               bestRssi = rssi;
+               bestFreq = freq;
+            }
+         }
+      }
+      _monitor._nextAF = (_monitor._nextAF + checks) % afCount;
+
+      if(bestRssi >= (actualRssi + FM_AF_RSSI_MARGIN))
+      {
+         /* Keep muted until PI is confirmed by RDS */
+         printf("[FM][AF] Try AF %f (%d dBuV)\n", bestFreq, bestRssi);
+         si470x_tuneFrequencyBlocking(bestFreq);
+         /* PI of original frequency must not confirm the switch. RDS interrupt
+          is needed to get PI of new AF before FM_AF_PI_TIMEOUT_MS */
+         fm_rdsService_newStation();
+         fm_rdsGate_newStation();
+         _monitor._verifyStation = fm_rdsRing_getStation();
+         _monitor._verifyPI      = pi;
+         _monitor._verifyStartMs = to_ms_since_boot(get_absolute_time());
+      }
+      else
+      {
+         si470x_tuneFrequencyBlocking(_monitor._originalFreq);
+         si470x_setMute(_monitor._wasMuted);
+      }
+      fm_rdsRing_enable(true);
+   }
+}
+
+static void fm_afSwitch_revert(void)
+{
+   /* Last group of AF must not be captured during tune */
+   fm_rdsRing_enable(false);
+   si470x_tuneFrequencyBlocking(_monitor._originalFreq);
+   si470x_setMute(_monitor._wasMuted);
+   _monitor._verifyPI    = RDS_CACHE_PI_UNKNOWN;
+   _monitor._rssiSamples = 0x00;
+
+   /* Groups of another programme may have been decoded meanwhile */
+   fm_rdsService_newStation();
+   fm_rdsGate_newStation();
+   fm_rdsRing_enable(true);
+}
+
+static uint8_t fm_afSwitch_averageRSSI(void)
+{
+   uint16_t sum   = 0x0000;
+   uint8_t  index = 0x00;
+
+   for(index = 0; index < _monitor._rssiSamples; index++)
+   {
+      sum += _monitor._rssiHistory[index];
+   }
+   return (0 < _monitor._rssiSamples) ? (uint8_t)(sum / _monitor._rssiSamples) : 0x00;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file    si470x_afSwitch.h
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Automatic switch to an alternative frequency (AF) when signal of
+ *          actual station fades. RSSI is sampled periodically while RDS is
+ *          decoded. When its average falls under FM_AF_WEAK_RSSI, audio is
+ *          muted and some AF of the programme (AF lists are cached per PI, see
+ *          rdsCache.h) are tuned one after the other to measure their RSSI.
+ *          Strongest one is kept if it is clearly better, then its PI is
+ *          checked on first RDS group before audio comes back. Otherwise,
+ *          original frequency is tuned again.
+ * @version 0.1
+ * @date    2023-09-11
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _SI470X_AFSWITCH_H_
+#define _SI470X_AFSWITCH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "si470x_driver.h"
+
+#define FM_AF_RSSI_PERIOD_MS  500U   /* RSSI sampling period */
+#define FM_AF_RSSI_HISTORY    6U     /* Samples averaged, 3 s. A short fading must not trigger a switch */
+#define FM_AF_WEAK_RSSI       20U    /* dBµV, average under it: look for a better AF */
+#define FM_AF_RSSI_MARGIN     6U     /* dB, an AF must be that much stronger to switch to it */
+#define FM_AF_MAX_CHECKS      4U     /* AF tuned per attempt, ~60 ms each while muted */
+#define FM_AF_PI_TIMEOUT_MS   400U   /* RDS group with PI expected meanwhile on new AF (~88 ms per group) */
+#define FM_AF_HOLDOFF_MS      15000U /* Pause between two attempts on a weak station */
+
+/**
+ * @brief Signal monitor and AF switch state
+ */
+typedef struct {
+   uint8_t  _rssiHistory[FM_AF_RSSI_HISTORY]; /* Last RSSI samples */
+   uint8_t  _rssiIndex;                       /* Next sample to overwrite */
+   uint8_t  _rssiSamples;                     /* Valid samples in history */
+   uint32_t _lastSampleMs;                    /* Time of last RSSI sample */
+   uint32_t _lastAttemptMs;                   /* Time of last AF attempt */
+   uint8_t  _nextAF;                          /* First AF to check at next attempt, all get their turn */
+   uint16_t _verifyPI;                        /* PI expected on new AF, 0 if no switch on going */
+   uint8_t  _verifyStation;                   /* RDS station counter of new AF, see fm_rdsRing_newStation() */
+   uint32_t _verifyStartMs;                   /* Time of switch to new AF */
+   float    _originalFreq;                    /* Frequency before switch, to come back to */
+   bool     _wasMuted;                        /* Mute state chosen by user before switch */
+} fm_afSwitch_monitor;
+
+/**
+ * @brief Init AF switch, no station monitored yet
+ */
+void fm_afSwitch_init(void);
+
+/**
+ * @brief Call it after each seek or tune of user. Restarts RSSI history and
+ * cancels any AF switch on going.
+ */
+void fm_afSwitch_newStation(void);
+
+/**
+ * @brief Call it periodically while RDS is decoded. Samples RSSI and switches
+ * to an AF if signal is too weak. May block for a few hundreds of ms while
+ * AF are checked, audio muted.
+ *
+ * @param pi  [in] uint16_t PI of actual station, 0 if still unknown
+ */
+void fm_afSwitch_process(uint16_t pi);
+
+/**
+ * @brief Call it after each RDS group decoded. Confirms or cancels a switch
+ * on going, depending on PI received on new AF. PI decoded before the switch
+ * (other station counter) is ignored.
+ *
+ * @param  pi      [in] uint16_t PI of last RDS group
+ * @param  station [in] uint8_t station counter of the snapshot PI comes from
+ * @return true  if a switch to an AF was just confirmed (frequency changed)
+ * @return false otherwise
+ */
+bool fm_afSwitch_rdsGroup(uint16_t pi, uint8_t station);
+
+#endif /* _SI470X_AFSWITCH_H_ */
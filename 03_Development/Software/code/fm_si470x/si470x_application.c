@@ -15,33 +15,83 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include "si470x_application.h"
 #include "si470x_comm.h"
+#include "si470x_seekSens.h"
+#include "si470x_afSwitch.h"
+#include "si470x_seekTune.h"
+#include "si470x_rdsGate.h"
+#include "si470x_presetCheck.h"
+#include "si470x_directTune.h"
+#include "si470x_rdsRing.h"
+#include "si470x_rdsService.h"
+#include "si470x_region.h"
 #include "rdsDecoder.h"
+#include "rdsCache.h"
 #include "bt_rn52_application.h"
 #include "ep_application.h"
 #include "hal_main.h"
+#include "nv_application.h"
 
-/* @todo add doxygen comments for those functions */
-static void processSTCEvent(bool seekTune);
-static void processRDSEvent(void);
+/**
+ * @brief Seek and tune engine callback: a seek or tune is finished
+ *
+ * @param op      [in] FM_SEEKTUNE_OP operation finished
+ * @param result  [in] FM_SEEKTUNE_RESULT how it finished
+ * @param rssi    [in] uint8_t RSSI of new station
+ */
+static void processSTCEvent(FM_SEEKTUNE_OP op, FM_SEEKTUNE_RESULT result, uint8_t rssi);
+/* @brief Handle what RDS service decoded since last call: RDS cache, e-paper, AF switch and gating */
+static void processRDSSnapshot(void);
+/* @brief Restore presets and RDS cache from non volatile memory */
+static void fm_restoreSavedState(void);
+/* @brief Restore volume and last station from non volatile memory, once Si470x is powered up.
+   Last station is tuned through seek and tune engine, or right away if blocking */
+static void fm_restoreSavedStation(bool blocking);
+/* @brief Si470x never used since boot: cold power up, restore last station, then standby */
+static void fm_powerUpToStandby(void);
+/* @brief New station tuned: reset RDS decoder and show cached RDS data of it, if any */
+static void fm_newStation(void);
+/* @brief Write a text of a given size on e-paper, splitted on lines. Shown by next fm_displayProcess() */
+static void fm_showText(EPAPER_PLACE place, const uint8_t *text, uint8_t size);
+/* @brief Refresh e-paper once for all texts written since last refresh, at most every FM_DISPLAY_PERIOD_MS */
+static void fm_displayProcess(void);
+
+/* Preset of a frequency in MHz. Its channel is computed at compile time */
+#define FM_PRESET_INIT(freq, name) {freq, name, 0, 0, false, SI470X_KHZ_TO_CHANNEL(SI470X_MHZ_TO_KHZ(freq))}
 
 static fm_station_preset stationsPresets[] =
-{{88.8f,  "BernObrl\0"},  /* Radio Bern oberland, OOOOOOOOHHH YEAAAHHH */
- {88.9f,  "not set \0"},
- {90.0f,  "not set \0"},
- {91.0f,  "not set \0"},
- {92.0f,  "not set \0"},
- {93.2f,  "Clasic21\0"},  /* Classic 21 */
- {100.0f, "not set \0"},
- {104.0f, "not set \0"},
- {106.0f, "not set \0"},
- {107.7f, "Neue1077\0"}   /* THE Neue 107.7 Stuttgart love it */
+{FM_PRESET_INIT(88.8f,  "BernObrl\0"),  /* Radio Bern oberland, OOOOOOOOHHH YEAAAHHH */
+ FM_PRESET_INIT(88.9f,  "not set \0"),
+ FM_PRESET_INIT(90.0f,  "not set \0"),
+ FM_PRESET_INIT(91.0f,  "not set \0"),
+ FM_PRESET_INIT(92.0f,  "not set \0"),
+ FM_PRESET_INIT(93.2f,  "Clasic21\0"),  /* Classic 21 */
+ FM_PRESET_INIT(100.0f, "not set \0"),
+ FM_PRESET_INIT(104.0f, "not set \0"),
+ FM_PRESET_INIT(106.0f, "not set \0"),
+ FM_PRESET_INIT(107.7f, "Neue1077\0")   /* THE Neue 107.7 Stuttgart love it */
 };
 
 FM_STATE fmState;
 /* Notify IRQ to process the interrupt */
 uint8_t tokenIRQ_GPIO2 = 0x00;
+/* Direction of last seek, to seek again with another sensitivity preset */
+static uint8_t _seekDirection = 0x01;
+/* What RE2 turns do */
+static FM_TUNE_MODE _tuneMode = FM_TUNE_MODE_SEEK;
+/* Last preset recalled, next one is searched from there */
+static uint8_t _presetIndex = 0x00;
+/* Qty of AF codes of actual station already put in RDS cache */
+static uint8_t _afCountCached = 0x00;
+/* Last snapshot of RDS service handled, its event counters are compared with next one */
+static fm_rdsSnapshot _rdsLast;
+/* Cold power up already tried by background work, a failing Si470x must not block each loop */
+static bool _backgroundPowerUp = false;
+/* Texts written on e-paper, not refreshed yet. RT prefix and dynamic PS change often */
+static bool     _displayPending = false;
+static uint32_t _lastDisplayMs  = 0x00;
 
 void fm_si470xGpio2_callback(void)
 {
@@ -49,12 +99,16 @@ void fm_si470xGpio2_callback(void)
    && (FM_STATE_PWRUP != fmState))
    {
       tokenIRQ_GPIO2 = 0x01;
+      /* RDS group read now, before Si470x replaces it */
+      fm_rdsRing_irq();
 //      fm_stateMachine();
    }
 }
 
 void fm_stateMachine(void)
 {
+   rds_groupBlocks polledGroup;
+
    switch(fmState)
    {
       case FM_STATE_INIT:
@@ -62,11 +116,12 @@ void fm_stateMachine(void)
          fmState = FM_STATE_PWRUP; 
          break;
       case FM_STATE_PWRUP:
-         /* Power up and configure radio */
+         /* Cold power up and configure radio, first time FM is used */
          if(si470x_powerUp())
          {
             /* All good, wait for human commands */
             fmState = FM_STATE_IDLE;
+            fm_restoreSavedStation(false);
          }
          else
          {
@@ -74,32 +129,36 @@ void fm_stateMachine(void)
          }
          break;
       case FM_STATE_PWRDWN:
-         si470x_powerDown();
+         /* Standby, wait for fm_activate() */
          break;
       case FM_STATE_IDLE:
          /* Wait for Seek or tune event from human */
 //         ep_write(EPAPER_PLACE_ACTIVEMODE, 0, "Radio - FM demodulator", true);
-
+         fm_seekTune_process(false);
          break;
       case FM_STATE_SEEKING:
-         if(0x01 == tokenIRQ_GPIO2)
-         {
-            processSTCEvent(true);
-            tokenIRQ_GPIO2 = 0x00;
-         }
-         break;
       case FM_STATE_TUNING:
-         if(0x01 == tokenIRQ_GPIO2)
-         {
-            processSTCEvent(false);
-            tokenIRQ_GPIO2 = 0x00;
-         }
+         /* GPIO2 interrupt is STC. Engine polls it too, in case an interrupt was lost */
+         fm_seekTune_process(0x01 == tokenIRQ_GPIO2);
+         tokenIRQ_GPIO2 = 0x00;
          break;
       case FM_STATE_RDS:
-         if(0x01 == tokenIRQ_GPIO2)
+         /* Groups are captured by GPIO2 interrupt and decoded on core1, handle what it found */
+         tokenIRQ_GPIO2 = 0x00;
+         fm_rdsRing_process();
+         /* RDS interrupt off once PS and RT are confirmed, groups are polled instead */
+         if(true == fm_rdsGate_process(&polledGroup))
          {
-            processRDSEvent();
-            tokenIRQ_GPIO2 = 0x00;
+            fm_rdsRing_push(&polledGroup);
+         }
+         processRDSSnapshot();
+         fm_rdsService_statsProcess();
+         /* Start user intents, or wait for end of previous one */
+         fm_seekTune_process(false);
+         /* Watch signal, switch to an alternative frequency if it fades */
+         if(true == fm_seekTune_isIdle())
+         {
+            fm_afSwitch_process(_rdsLast._pi);
          }
          break;
       case FM_STATE_MAX:
@@ -107,33 +166,168 @@ void fm_stateMachine(void)
          printf("[FM][APP] ERROR - unknown state of FM module: 0x%02x\n", fmState);
          break;
    }
+
+   /* Knob settled in direct tuning mode, one tune for the whole twist */
+   if((FM_STATE_IDLE <= fmState) && (FM_STATE_MAX > fmState) && (true == fm_directTune_process()))
+   {
+      fm_seekTune_requestTuneChannel(fm_directTune_getTarget(), &processSTCEvent);
+   }
+
+   /* GPIO2 is an RDS interrupt only while decoding, an STC one otherwise */
+   fm_rdsRing_enable(FM_STATE_RDS == fmState);
+
+   /* Engine started a queued intent */
+   if(FM_SEEKTUNE_OP_SEEK == fm_seekTune_getActive())
+   {
+      fmState = FM_STATE_SEEKING;
+   }
+   else if(FM_SEEKTUNE_OP_TUNE == fm_seekTune_getActive())
+   {
+      fmState = FM_STATE_TUNING;
+   }
+
+   /* One refresh for all texts changed meanwhile, a refresh blocks main loop */
+   fm_displayProcess();
 }
 
 void fm_init(void)
 {
    printf("[FM][APP] Init application\n");
 
-   /* Init Si470x module */
+   /* Init Si470x module. It is powered up by state machine, only once FM is
+    activated: radio starts in BT mode most of the time */
    si470x_init();
-   si470x_powerUp();
+   fm_seekSens_init();
+   fm_seekTune_init();
 
    /* Declare callback of GPIO2 done in hal_gpio */
    tokenIRQ_GPIO2 = 0x00;
 
-   /* Init RDS decoder, less quality for more verbose */
-   rdsDecoder_init(RT_STATE_QUALITY_BAD, false);
+   /* RDS decoding runs on core1, with its own decoder: less quality for more verbose */
+   rdsCache_init();
+   fm_afSwitch_init();
+   fm_rdsGate_init();
+   fm_rdsRing_init();
+   fm_rdsService_init(RT_STATE_QUALITY_BAD);
+   memset(&_rdsLast, 0, sizeof(_rdsLast));
+   memset(&_rdsLast._psName[0], 0x20, PS_GROUP_MAX_CHARS);
+   fm_presetCheck_init();
+   fm_directTune_init();
+
+   fmState = FM_STATE_PWRUP;
 
-   fmState = FM_STATE_IDLE;
+   /* Restore what was saved before last power-off */
+   fm_restoreSavedState();
+}
+
+static void fm_restoreSavedState(void)
+{
+   rds_cachePersist cacheTable[RDS_CACHE_ENTRIES];
+   uint8_t          seekScores[FM_SEEK_SENSITIVITY_MAX];
+
+   /* Keep hard-coded presets if none saved yet */
+   if(nv_get(NV_KEY_FM_PRESETS, &stationsPresets[0], sizeof(stationsPresets)))
+   {
+      printf("[FM][APP] Presets restored\n");
+   }
+
+   /* PS names of last stations, shown right after tune */
+   if(nv_get(NV_KEY_RDS_CACHE, &cacheTable[0], sizeof(cacheTable)))
+   {
+      rdsCache_import(&cacheTable[0]);
+   }
+
+   /* First seek uses the preset which worked best until now */
+   if(nv_get(NV_KEY_FM_SEEKSENS, &seekScores[0], sizeof(seekScores)))
+   {
+      fm_seekSens_import(&seekScores[0]);
+   }
+}
+
+static void fm_restoreSavedStation(bool blocking)
+{
+   uint8_t volume   = 0x00;
+   float   lastFreq = 0.0f;
+
+   if(nv_get(NV_KEY_FM_VOLUME, &volume, sizeof(volume)))
+   {
+      si470x_setVolume(volume, si470x_getVolext());
+   }
+
+   /* Tune directly to last station, no need to seek */
+   if(nv_get(NV_KEY_FM_LASTFREQ, &lastFreq, sizeof(lastFreq)))
+   {
+      printf("[FM][APP] Tune to last station %f\n", lastFreq);
+      if(true == blocking)
+      {
+         si470x_tuneFrequencyBlocking(lastFreq);
+      }
+      else
+      {
+         fm_tuneFrequency(lastFreq);
+      }
+   }
+}
+
+static void fm_powerUpToStandby(void)
+{
+   _backgroundPowerUp = true;
+   if(true == si470x_powerUp())
+   {
+      /* Same standby as after FM was used: fm_activate() resumes last station */
+      fm_restoreSavedStation(true);
+      si470x_powerDown();
+      fmState = FM_STATE_PWRDWN;
+   }
+   else
+   {
+      printf("[FM][APP] - ERROR while powering up Si470x module in background\n");
+   }
+}
+
+void fm_backgroundProcess(void)
+{
+   /* Radio booted in BT mode: Si470x was never powered up, check needs warm standby */
+   if((FM_STATE_PWRUP == fmState) && (false == _backgroundPowerUp) && (true == fm_presetCheck_isDue()))
+   {
+      fm_powerUpToStandby();
+   }
+
+   /* Tuner is unused, refresh presets. Saved once user stopped changing anything */
+   if(true == fm_presetCheck_process(&stationsPresets[0], MAX_PRESETS))
+   {
+      nv_set(NV_KEY_FM_PRESETS, &stationsPresets[0], sizeof(stationsPresets));
+   }
 }
 
 void fm_deactivate(void)
 {
    hal_deactivateFM();
+   fm_rdsRing_enable(false);
+   fm_presetCheck_abort();
+
+   /* Standby keeps oscillator and registers, for a fast resume */
+   if(true == si470x_isPoweredUp())
+   {
+      si470x_powerDown();
+      fmState = FM_STATE_PWRDWN;
+   }
 }
 
 void fm_activate(void)
 {
+   /* Si470x back in standby, with station and mute of user */
+   fm_presetCheck_abort();
    hal_activateFM();
+   /* A seek or tune which finished while GPIO2 interrupt was deactivated is
+    found by STC polling of seek and tune engine */
+
+   /* Warm resume: no reset sequence, no oscillator wait. Tune again to get audio */
+   if((FM_STATE_PWRDWN == fmState) && (true == si470x_resume()))
+   {
+      fmState = FM_STATE_IDLE;
+      fm_tuneFrequency(si470x_getFrequency());
+   }
 }
 
 void fm_setVolume(bool upDown)
@@ -149,25 +343,57 @@ void fm_setVolume(bool upDown)
    }
    /* else, already at max or min*/
    si470x_setVolume(fmModuleVolume, false); /* @TODO check volume Extension use */
+   nv_set(NV_KEY_FM_VOLUME, &fmModuleVolume, sizeof(fmModuleVolume));
 }
 
 void fm_saveTuneFreq(uint8_t indexPresets)
 {
-   if(MAX_PRESETS >= indexPresets)
+   if(MAX_PRESETS > indexPresets)
    {
-      uint8_t pointerToPSname[PS_GROUP_MAX_CHARS];
       uint8_t index = 0x00;
 
-      stationsPresets[indexPresets].preset_freq = si470x_getFrequency();
-
-      /* @TODO check if PS name is good */
-      rdsDecoder_getPS(&pointerToPSname[0]);
+      stationsPresets[indexPresets].preset_freq       = si470x_getFrequency();
+      stationsPresets[indexPresets].preset_channel    = si470x_getChannel();
+      stationsPresets[indexPresets].preset_weakChecks = 0x00;
+      stationsPresets[indexPresets].preset_dead       = false;
 
+      /* Last stable PS name, spaces if none yet */
       for(;index < PS_GROUP_MAX_CHARS; index++)
       {
-         stationsPresets[indexPresets].preset_PSname[index] = *(pointerToPSname + index);
+         stationsPresets[indexPresets].preset_PSname[index] = _rdsLast._psName[index];
       }
+
+      nv_set(NV_KEY_FM_PRESETS, &stationsPresets[0], sizeof(stationsPresets));
+   }
+}
+
+bool fm_recallPreset(uint8_t indexPresets)
+{
+   bool retVal = false;
+
+   if((MAX_PRESETS > indexPresets) && (false == stationsPresets[indexPresets].preset_dead))
+   {
+      /* Label at once, preset hopping never waits for RDS */
+      fm_showText(EPAPER_PLACE_FM_STATION, (const uint8_t *)&stationsPresets[indexPresets].preset_PSname[0], PS_GROUP_MAX_CHARS);
+      retVal = fm_seekTune_requestTuneChannel(stationsPresets[indexPresets].preset_channel, &processSTCEvent);
+      _presetIndex = indexPresets;
+   }
+   return retVal;
+}
+
+bool fm_recallNextPreset(uint8_t upDown)
+{
+   uint8_t index = _presetIndex;
+   uint8_t tries = 0x00;
+   bool retVal = false;
+
+   while((false == retVal) && (MAX_PRESETS > tries))
+   {
+      index = (0x01 == upDown) ? ((index + 1) % MAX_PRESETS) : ((index + MAX_PRESETS - 1) % MAX_PRESETS);
+      retVal = fm_recallPreset(index);
+      tries++;
    }
+   return retVal;
 }
 
 void fm_printStationPresets(void)
@@ -175,7 +401,9 @@ void fm_printStationPresets(void)
    uint8_t index = 0;
    for(; index < MAX_PRESETS ;index++)
    {
-      printf("[FM][APP] Station %d: %s - FM: %f\n", (index+1), stationsPresets[index].preset_PSname, stationsPresets[index].preset_freq);
+      printf("[FM][APP] Station %d: %s - FM: %f - RSSI: %d%s\n", (index+1), stationsPresets[index].preset_PSname,
+             stationsPresets[index].preset_freq, stationsPresets[index].preset_rssi,
+             (true == stationsPresets[index].preset_dead) ? " - dead" : "");
    }
 }
 
@@ -188,57 +416,226 @@ bool fm_startSeekChannel(uint8_t upDown)
 {
    bool retVal = false;
 
-   if (si470x_getSTCbit())
+   /* Seek is started by engine once previous one is stopped and STC cleared */
+   if(true == fm_seekTune_requestSeek(upDown, &processSTCEvent))
    {
-      if(true == si470x_startSeek(upDown))
-      {
-         fmState = FM_STATE_SEEKING;
-         retVal  = true;
-      }
+      _seekDirection = upDown;
+      retVal = true;
    }
-
    return retVal;
 }
 
-static void processSTCEvent(bool seekTune)
+void fm_toggleTuneMode(void)
+{
+   _tuneMode = (_tuneMode + 1) % FM_TUNE_MODE_MAX;
+   printf("[FM][APP] RE2 tune mode: %d\n", _tuneMode);
+}
+
+void fm_rotaryTurn(uint8_t upDown)
+{
+   switch(_tuneMode)
+   {
+      case FM_TUNE_MODE_DIRECT:
+         fm_directTune_step(0x01 == upDown);
+         break;
+      case FM_TUNE_MODE_PRESET:
+         fm_recallNextPreset(upDown);
+         break;
+      case FM_TUNE_MODE_SEEK:
+      default:
+         fm_startSeekChannel(upDown);
+         break;
+   }
+}
+
+bool fm_tuneFrequency(float freq)
 {
-   uint8_t data_RSSI;
-   data_RSSI = si470x_seekTune_finished(seekTune);
+   return fm_seekTune_requestTune(freq, &processSTCEvent);
+}
+
+static void processSTCEvent(FM_SEEKTUNE_OP op, FM_SEEKTUNE_RESULT result, uint8_t rssi)
+{
+   bool    seekAgain = false;
+   uint8_t seekScores[FM_SEEK_SENSITIVITY_MAX];
+
+   /* Cancelled, timed out or not started seeks say nothing about sensitivity preset */
+   if((FM_SEEKTUNE_OP_SEEK == op)
+   && ((FM_SEEKTUNE_RESULT_OK == result) || (FM_SEEKTUNE_RESULT_FAILED == result)))
+   {
+      seekAgain = fm_seekSens_seekFinished(rssi);
+      fm_seekSens_export(&seekScores[0]);
+      nv_set(NV_KEY_FM_SEEKSENS, &seekScores[0], sizeof(seekScores));
+   }
 
-   if(0 < data_RSSI)
+   if(FM_SEEKTUNE_RESULT_OK == result)
    {
-      printf("[FM][APP] SeekTune finished, RSSI: %d, Freq: %f\n", data_RSSI, si470x_getFrequency());
+      float freq = si470x_getFrequency();
+      printf("[FM][APP] SeekTune finished, RSSI: %d, Freq: %f\n", rssi, freq);
+      /* Remember it as last station, saved into flash once user stopped changing station */
+      nv_set(NV_KEY_FM_LASTFREQ, &freq, sizeof(freq));
+      fm_newStation();
       fmState = FM_STATE_RDS; /* Finished with SeekTune, go to RDS decoding */
    }
    else
    {
-      /* Error while SeekTune, return to IDLE state */
-      /* @TODO If state was SEEKING. maybe try some other seek sensibility */
+      /* Error while SeekTune, return to IDLE state. Next intent in queue, if any, starts from there */
       fmState = FM_STATE_IDLE;
-      printf("[FM][APP] Seek or Tune error\n");
+      printf("[FM][APP] Seek or Tune error: %d\n", result);
+
+      /* Seek found nothing on the whole band, a more sensitive preset was selected: try again */
+      if(true == seekAgain)
+      {
+         fm_startSeekChannel(_seekDirection);
+      }
    }
 }
 
-static void processRDSEvent(void)
+static void processRDSSnapshot(void)
 {
-   uint8_t rtMsg[RT_GROUP_MAX_CHARS];
-   uint8_t sizeOfRTmsg = 0x00;
-   rds_groupBlocks tempGroup;
-   uint8_t index = 0;
+   fm_rdsSnapshot   snapshot;
+   rds_cachePersist cacheTable[RDS_CACHE_ENTRIES];
+   uint8_t  index   = 0;
+   uint16_t channel = si470x_getChannel();
+   float    freq    = 0.0f;
+   bool     rtComplete = false;
 
-   /* GPIO2 interrupt = we have RDS data */
-   si470x_getBlocks(&tempGroup);
-   sizeOfRTmsg = rdsDecoder_processNewGroup(&rtMsg[0], &tempGroup);
-   if(0 < sizeOfRTmsg)
+   /* Nothing new, or core1 did not reset decoder for actual station yet */
+   if((true == fm_rdsService_getSnapshot(&snapshot))
+   && ((snapshot._station != _rdsLast._station) || (snapshot._groups != _rdsLast._groups)))
    {
-      printf("[FM][APP] RDS event - %d\n", sizeOfRTmsg);
-      index = 0;
-      for(;index < sizeOfRTmsg; index++)
+      /* Counters of core1 restart with each station */
+      if(snapshot._station != _rdsLast._station)
       {
-         printf("%c", rtMsg[index]);
+         memset(&_rdsLast, 0, sizeof(_rdsLast));
       }
+
+      /* Same programme found on an alternative frequency, remember it as last station */
+      if(true == fm_afSwitch_rdsGroup(snapshot._pi, snapshot._station))
+      {
+         freq = si470x_getFrequency();
+         nv_set(NV_KEY_FM_LASTFREQ, &freq, sizeof(freq));
+      }
+
+      /* AF list grows while 0A groups are received */
+      if((snapshot._afCount != _afCountCached) && (RDS_CACHE_PI_UNKNOWN != snapshot._pi))
+      {
+         rdsCache_storeAF(snapshot._pi, channel, &snapshot._afList[0], snapshot._afCount);
+         _afCountCached = snapshot._afCount;
+      }
+
+      rtComplete = (snapshot._rtCompletes != _rdsLast._rtCompletes);
+      fm_rdsGate_group((snapshot._rtGroups != _rdsLast._rtGroups), snapshot._rtAbFlag, snapshot._psComplete, rtComplete);
+
+      /* Fresh PS name confirms or replaces the cached one. Screen is updated only once it converged */
+      if(snapshot._psEvents != _rdsLast._psEvents)
+      {
+         if(true == snapshot._psDynamic)
+         {
+            /* Scrolling text, not a station name: shown, but not cached */
+            fm_showText(EPAPER_PLACE_FM_STATION, &snapshot._psName[0], PS_GROUP_MAX_CHARS);
+         }
+         else if((RDS_CACHE_PI_UNKNOWN != snapshot._pi) && (true == rdsCache_storePS(snapshot._pi, channel, &snapshot._psName[0], snapshot._pty)))
+         {
+            fm_showText(EPAPER_PLACE_FM_STATION, &snapshot._psName[0], PS_GROUP_MAX_CHARS);
+            rdsCache_export(&cacheTable[0]);
+            nv_set(NV_KEY_RDS_CACHE, &cacheTable[0], sizeof(cacheTable));
+         }
+      }
+
+      if(true == rtComplete)
+      {
+         printf("[FM][APP] RDS event - %d\n", snapshot._rtSize);
+         index = 0;
+         for(;index < snapshot._rtSize; index++)
+         {
+            printf("%c", snapshot._rt[index]);
+         }
+         rdsCache_storeRT(snapshot._pi, channel, &snapshot._rt[0], snapshot._rtSize);
+         fm_showText(EPAPER_PLACE_FM_RADIOTEXT, &snapshot._rt[0], snapshot._rtSize);
+      }
+      else if(snapshot._rtPrefixes != _rdsLast._rtPrefixes)
+      {
+         /* Long RT takes seconds to confirm: show its beginning, word by word */
+         fm_showText(EPAPER_PLACE_FM_RADIOTEXT, &snapshot._rtPrefix[0], snapshot._rtPrefixSize);
+      }
+      /* @TODO mechanism to keep reading new track names. 
+         It changes even if we stay on same channel. If jump to
+         IDLE state, no further read of RT msg will be done */
+
+      _rdsLast = snapshot;
+   }
+}
+
+static void fm_newStation(void)
+{
+   const rds_cacheEntry *cached;
+   uint16_t channel = si470x_getChannel();
+   uint8_t  index   = 0x00;
+
+   /* RDS data of previous station is meaningless now */
+   fm_rdsService_newStation();
+   memset(&_rdsLast._psName[0], 0x20, PS_GROUP_MAX_CHARS);
+   _rdsLast._pi = 0x0000;
+   fm_afSwitch_newStation();
+   fm_rdsGate_newStation();
+   _afCountCached = 0x00;
+
+   /* PI is not known yet, search by channel only */
+   cached = rdsCache_find(RDS_CACHE_PI_UNKNOWN, channel);
+   if(NULL != cached)
+   {
+      printf("[FM][APP] Cached station PI: 0x%04x\n", cached->_pi);
+      fm_showText(EPAPER_PLACE_FM_STATION, &cached->_ps[0], PS_GROUP_MAX_CHARS);
+      fm_showText(EPAPER_PLACE_FM_RADIOTEXT, &cached->_rt[0], cached->_rtSize);
+   }
+   else
+   {
+      /* Not in RDS cache: a preset may still know its name */
+      while((MAX_PRESETS > index) && (channel != stationsPresets[index].preset_channel))
+      {
+         index++;
+      }
+      if(MAX_PRESETS > index)
+      {
+         fm_showText(EPAPER_PLACE_FM_STATION, (const uint8_t *)&stationsPresets[index].preset_PSname[0], PS_GROUP_MAX_CHARS);
+      }
+      else
+      {
+         fm_showText(EPAPER_PLACE_FM_STATION, NULL, 0);
+      }
+      fm_showText(EPAPER_PLACE_FM_RADIOTEXT, NULL, 0);
+   }
+}
+
+static void fm_showText(EPAPER_PLACE place, const uint8_t *text, uint8_t size)
+{
+   char    line[EPAPER_CHARS_PER_LINE];
+   uint8_t lineIndex = 0x00;
+   uint8_t charIndex = 0x00;
+   uint8_t textIndex = 0x00;
+
+   /* RT is up to 64 characters, it takes 3 lines. Empty lines clean previous text */
+   for(lineIndex = 0; lineIndex < 3; lineIndex++)
+   {
+      for(charIndex = 0; (charIndex < (EPAPER_CHARS_PER_LINE - 1)) && (textIndex < size); charIndex++)
+      {
+         line[charIndex] = (char)text[textIndex];
+         textIndex++;
+      }
+      line[charIndex] = '\0';
+      ep_write(place, lineIndex, &line[0], false);
+   }
+   _displayPending = true;
+}
+
+static void fm_displayProcess(void)
+{
+   uint32_t nowMs = to_ms_since_boot(get_absolute_time());
+
+   if((true == _displayPending) && (FM_DISPLAY_PERIOD_MS <= (nowMs - _lastDisplayMs)))
+   {
+      ep_flush();
+      _displayPending = false;
+      _lastDisplayMs  = nowMs;
    }
-   /* @TODO mechanism to keep reading new track names. 
-      It changes even if we stay on same channel. If jump to
-      IDLE state, no further read of RT msg will be done */
 }
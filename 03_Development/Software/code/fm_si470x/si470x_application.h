@@ -17,6 +17,7 @@
 #include "rdsDecoder.h"
 
 #define MAX_PRESETS 10
+#define FM_DISPLAY_PERIOD_MS 2000U   /* Minimum time between two e-paper refreshes of station texts */
 
 typedef enum{
    FM_STATE_INIT = 0,
@@ -37,9 +38,21 @@ typedef enum {
    ROTARY_MAX
 } ROTARY;
 
+typedef enum {
+   FM_TUNE_MODE_SEEK = 0,  /* RE2 turn seeks next station */
+   FM_TUNE_MODE_DIRECT,    /* RE2 turn moves frequency, see si470x_directTune.h */
+   FM_TUNE_MODE_PRESET,    /* RE2 turn recalls next or previous preset */
+   /* Keep at the end */
+   FM_TUNE_MODE_MAX
+} FM_TUNE_MODE;
+
 typedef struct {
-   float preset_freq;
-   char  preset_PSname[PS_GROUP_MAX_CHARS+1];   /* Add +1 for \0 end of chain char */
+   float   preset_freq;
+   char    preset_PSname[PS_GROUP_MAX_CHARS+1];   /* Add +1 for \0 end of chain char */
+   uint8_t preset_rssi;          /* RSSI at last background check, 0 if never checked */
+   uint8_t preset_weakChecks;    /* Background checks in a row with a too weak RSSI */
+   bool    preset_dead;          /* Station does not come in anymore, skipped at recall */
+   uint16_t preset_channel;      /* CHANNEL value of preset_freq, recall needs no conversion */
 } fm_station_preset;
 
 /**
@@ -55,6 +68,12 @@ void fm_init(void);
 void fm_deactivate(void);
 void fm_activate(void);
 
+/**
+ * @brief Background work of FM module while it is not the active mode
+ *        (radio in BT or IDLE mode): presets health check
+ */
+void fm_backgroundProcess(void);
+
 /**
  * @brief Callback in case of GPIO2 interrupt from si470x
  */
@@ -80,6 +99,25 @@ void fm_setVolume(bool upDown);
  */
 void fm_saveTuneFreq(uint8_t indexPresets);
 
+/**
+ * @brief Recall a preset: its PS name is shown at once from preset, and its
+ *        channel is tuned without any conversion. RDS data confirms it later.
+ * 
+ * @param indexPresets  uint8_t, the preset index
+ * @return true         if tune was queued
+ * @return false        if wrong index, or preset flagged dead
+ */
+bool fm_recallPreset(uint8_t indexPresets);
+
+/**
+ * @brief Recall next or previous preset, dead presets are skipped
+ * 
+ * @param upDown  0x01 for next preset, 0x00 for previous one
+ * @return true   if tune was queued
+ * @return false  if all presets are dead
+ */
+bool fm_recallNextPreset(uint8_t upDown);
+
 /**
  * @brief Print saved station on stdio
  */
@@ -91,14 +129,37 @@ void fm_printStationPresets(void);
 void fm_toggleMute(void);
 
 /**
- * @brief  Start seeking a channel. It firstly check if STC bit was
- *         cleared. Which meands that previous seek or tune was
- *         complete. And it will initate a new seek tune sequence.
+ * @brief  Ask for a seek. It is queued into seek and tune engine, and
+ *         cancels a seek on going. It starts once previous seek or tune
+ *         is complete (STC bit cleared).
  * 
  * @param  [in] upDown 0x01 to search up, 0x00 to search down 
- * @return true if start seeking worked
+ * @return true if seek was queued
  * @return false if not
  */
 bool fm_startSeekChannel(uint8_t upDown);
 
+/**
+ * @brief  Switch RE2 between seek, direct tuning and preset recall
+ */
+void fm_toggleTuneMode(void);
+
+/**
+ * @brief  One detent of RE2. Seeks, moves frequency in direct tuning mode
+ *         (tuned once knob settled), or recalls next preset.
+ * 
+ * @param  [in] upDown 0x01 to go up, 0x00 to go down
+ */
+void fm_rotaryTurn(uint8_t upDown);
+
+/**
+ * @brief  Ask for a tune to a frequency. It is queued into seek and tune
+ *         engine, like fm_startSeekChannel()
+ * 
+ * @param  [in] freq frequency in MHz
+ * @return true if tune was queued
+ * @return false if not
+ */
+bool fm_tuneFrequency(float freq);
+
 #endif /* _SI470X_APPLICATION_H_ */
\ No newline at end of file
@@ -18,6 +18,9 @@
 
 // i2c_inst_t si470x_i2cInst;
 
+/* An I2C transfer is on going. Checked by GPIO2 interrupt before it reads RDS registers */
+static volatile bool _commBusy = false;
+
 /* -------------------------------------------------------------------------- */
 /* ------------------------ READ/WRITE TO Si470x ---------------------------- */
 
@@ -64,7 +67,7 @@ bool si470x_comm_readRegisters(uint16_t *regData, uint8_t regNbr)
    bool retVal = false;
 
    /* Check number of register asked */
-   if(SI470x_REG_MAX >= regNbr)
+   if(SI470x_REG_MAX > regNbr)
    {
       uint8_t bufData[SI4703_BYTES_FOR_STD_READ];
       uint8_t bufSize = 0x00;
@@ -86,7 +89,9 @@ bool si470x_comm_readRegisters(uint16_t *regData, uint8_t regNbr)
       bufSize = bufSizeRegs * sizeof(uint16_t);
 
       /* I2C call */
+      _commBusy  = true;
       int result = i2c_read_blocking(i2c_default, SI4703_ADDR, bufData, bufSize, false);
+      _commBusy  = false;
 
       /* Transform back data into registers */
       if (result == (int)bufSize) 
@@ -110,7 +115,13 @@ bool si470x_comm_readRegisters(uint16_t *regData, uint8_t regNbr)
          /* Restructure retrieved register array if we had to wrap around */
          if(regNbr < SI470x_REG_STATUSRSSI)
          {
-            for(indexReg = 0; indexReg < regNbr; indexReg++)
+            /* 0x0A to 0x0F are first in wrongOrderRegisters */
+            for(indexReg = SI470x_REG_STATUSRSSI; indexReg < SI470x_REG_MAX; indexReg++)
+            {
+               regData[indexReg] = wrongOrderRegisters[indexReg - SI470x_REG_STATUSRSSI];
+            }
+            /* Then 0x00 up to regNbr (included) */
+            for(indexReg = 0; indexReg <= regNbr; indexReg++)
             {
                /* Shift of 6 case because 0x0A to 0x0F are first in wrongOrderRegisters*/
                regData[indexReg] = wrongOrderRegisters[indexReg + 0x06];
@@ -118,12 +129,12 @@ bool si470x_comm_readRegisters(uint16_t *regData, uint8_t regNbr)
          }
          else
          {
-            /* Then, add registers 0x0A to max wanted. Fill lower ones with 0x00 */
+            /* Then, add registers 0x0A to max wanted (included). Fill lower ones with 0x00 */
             for(indexReg = 0x00; indexReg < SI470x_REG_STATUSRSSI; indexReg++)
             {
                regData[indexReg] = 0x00;
             }
-            for(indexReg = SI470x_REG_STATUSRSSI; indexReg < regNbr; indexReg++)
+            for(indexReg = SI470x_REG_STATUSRSSI; indexReg <= regNbr; indexReg++)
             {
                regData[indexReg] = wrongOrderRegisters[indexReg - SI470x_REG_STATUSRSSI];
             }
@@ -138,17 +149,23 @@ bool si470x_comm_readRegisters(uint16_t *regData, uint8_t regNbr)
    return retVal;
 }
 
+bool si470x_comm_isBusy(void)
+{
+   return _commBusy;
+}
+
 bool si470x_comm_writeRegisters(uint16_t *regData, uint8_t upperReg)
 {
    bool retVal = false;
    /* @WARNING checkt that I2C of Raspberry Pico RP2040 do send 8 bits of empty data before starting */
 
    /* Are register address write delimitations (see AN230) */
-   if((upperReg >= SI470x_REG_POWERCFG) || (upperReg < SI470x_REG_MAX))
+   if((upperReg >= SI470x_REG_POWERCFG) && (upperReg < SI470x_REG_MAX))
    {
       uint8_t buf[SI4703_BYTES_FOR_STD_WRITE];
       uint8_t index;
-      uint8_t data_size       = (uint8_t)(upperReg * sizeof(uint16_t));
+      /* From POWERCFG up to upperReg (included) */
+      uint8_t data_size       = (uint8_t)((upperReg - SI470x_REG_POWERCFG + 1) * sizeof(uint16_t));
       uint16_t *pointerToData = regData + SI470x_REG_POWERCFG; /* Start at POWERCFG */
       int writeRes            = PICO_ERROR_GENERIC;
 
@@ -161,7 +178,9 @@ bool si470x_comm_writeRegisters(uint16_t *regData, uint8_t upperReg)
       }
       
       /* Send to I2C - nonstop set to false, otherwise, error in Si470x internal register addr counter */
-      writeRes = i2c_write_blocking(i2c_default, SI4703_ADDR, buf, data_size, false);
+      _commBusy = true;
+      writeRes  = i2c_write_blocking(i2c_default, SI4703_ADDR, buf, data_size, false);
+      _commBusy = false;
       if(writeRes == data_size)
       {
          retVal = true;
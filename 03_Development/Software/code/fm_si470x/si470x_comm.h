@@ -57,13 +57,22 @@ bool si470x_comm_writeRegisters(uint16_t *regData, uint8_t upperReg);
  * 0x0 0x1 0x2 0x3 0x4 0x5 0x6 0x7 0x8 0x9|0xA 0xB 0xC 0xD 0xE 0xF 
  * --> carries on here (if needed)        |
  * 
- * @param regData       uint16_t* pointer to buffer to save data retreived
- * @param regNbr        uint8_t number of byte to retrieve from Si4703
+ * @param regData       uint16_t* pointer to buffer of SI470x_REG_MAX registers, indexed by register address
+ * @param regNbr        uint8_t last register address to retrieve from Si4703 (included)
  * @return true         if read successed (from i2c_read_blocking() call)
  * @return false        if read failed (from i2c_read_blocking() call)
  */
 bool si470x_comm_readRegisters(uint16_t *regData, uint8_t regNbr);
 
+/**
+ * @brief Check if an I2C transfer is on going. An interrupt handler must not
+ * start another one on top of it: it would corrupt both.
+ * 
+ * @return true         if a read or write is on going
+ * @return false        if I2C bus is free
+ */
+bool si470x_comm_isBusy(void);
+
 /**
  * @brief Init I2C communication for Si470x module with parameters defined in
  * preprocessor. Change preprocessor to adapt it to wished I2C communication. 
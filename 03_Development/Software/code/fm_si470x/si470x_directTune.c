@@ -0,0 +1,114 @@
+/**
+ * @file    si470x_directTune.c
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Velocity aware direct tuning. See si470x_directTune.h
+ * @version 0.1
+ * @date    2023-09-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "si470x_directTune.h"
+#include "si470x_region.h"
+#include "ep_application.h"
+
+static uint16_t _target;          /* Target channel */
+static bool     _pending;         /* Target not yet tuned */
+static bool     _displayPending;  /* Target not yet shown */
+static uint32_t _lastStepMs;      /* Time of last detent */
+static uint32_t _lastDisplayMs;   /* Time of last e-paper refresh */
+
+/**
+ * @brief Write target frequency on e-paper
+ */
+static void fm_directTune_show(void);
+
+void fm_directTune_init(void)
+{
+   _target         = 0x0000;
+   _pending        = false;
+   _displayPending = false;
+   _lastStepMs     = 0x00;
+   _lastDisplayMs  = 0x00;
+}
+
+void fm_directTune_step(bool up)
+{
+   uint32_t nowMs   = to_ms_since_boot(get_absolute_time());
+   uint32_t sinceMs = nowMs - _lastStepMs;
+   uint16_t step    = 0x0001;
+
+   /* Knob was at rest: start from station actually tuned */
+   if(false == _pending)
+   {
+      _target = si470x_getChannel();
+      sinceMs = FM_DIRECTTUNE_SETTLE_MS;
+   }
+
+   if(FM_DIRECTTUNE_FAST_MS > sinceMs)
+   {
+      step = FM_DIRECTTUNE_FAST_STEP_KHZ / SI470X_SPACING_KHZ;
+   }
+   else if(FM_DIRECTTUNE_MEDIUM_MS > sinceMs)
+   {
+      step = FM_DIRECTTUNE_MEDIUM_STEP_KHZ / SI470X_SPACING_KHZ;
+   }
+
+   /* Wrap around band limits, like a seek does */
+   if(true == up)
+   {
+      _target = (SI470X_CHANNEL_MAX >= ((uint32_t)_target + step)) ? (uint16_t)(_target + step) : 0x0000U;
+   }
+   else
+   {
+      _target = (_target >= step) ? (uint16_t)(_target - step) : (uint16_t)SI470X_CHANNEL_MAX;
+   }
+
+   _pending        = true;
+   _displayPending = true;
+   _lastStepMs     = nowMs;
+}
+
+bool fm_directTune_process(void)
+{
+   uint32_t nowMs  = to_ms_since_boot(get_absolute_time());
+   bool     retVal = false;
+
+   /* Frequency follows knob, e-paper refresh is limited while it spins */
+   if((true == _displayPending) && (FM_DIRECTTUNE_DISPLAY_MS <= (nowMs - _lastDisplayMs)))
+   {
+      fm_directTune_show();
+      _displayPending = false;
+      _lastDisplayMs  = nowMs;
+   }
+
+   if((true == _pending) && (FM_DIRECTTUNE_SETTLE_MS <= (nowMs - _lastStepMs)))
+   {
+      _pending = false;
+      /* Knob came back to station on air */
+      retVal = (_target != si470x_getChannel());
+   }
+   return retVal;
+}
+
+uint16_t fm_directTune_getTarget(void)
+{
+   return _target;
+}
+
+bool fm_directTune_isPending(void)
+{
+   return _pending;
+}
+
+static void fm_directTune_show(void)
+{
+   char     line[EPAPER_CHARS_PER_LINE];
+   uint32_t khz = SI470X_CHANNEL_TO_KHZ(_target);
+
+   snprintf(&line[0], sizeof(line), "%lu.%02lu MHz", (unsigned long)(khz / 1000U), (unsigned long)((khz % 1000U) / 10U));
+   ep_write(EPAPER_PLACE_FM_STATION, 0, &line[0], true);
+}
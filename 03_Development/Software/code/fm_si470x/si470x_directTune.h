@@ -0,0 +1,65 @@
+/**
+ * @file    si470x_directTune.h
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Velocity aware direct tuning with RE2. Each detent moves a target
+ *          channel, the faster the knob spins, the larger the step. Target
+ *          frequency is shown right away, but Si470x is tuned only once the
+ *          knob settles: one twist of knob is one tune, not one STC cycle per
+ *          detent.
+ * @version 0.1
+ * @date    2023-09-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _SI470X_DIRECTTUNE_H_
+#define _SI470X_DIRECTTUNE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "si470x_driver.h"
+
+#define FM_DIRECTTUNE_FAST_MS          50U    /* Detents closer than that: fast spin */
+#define FM_DIRECTTUNE_MEDIUM_MS        120U   /* Detents closer than that: medium spin */
+#define FM_DIRECTTUNE_FAST_STEP_KHZ    1000U
+#define FM_DIRECTTUNE_MEDIUM_STEP_KHZ  200U   /* Slow spin: one channel */
+#define FM_DIRECTTUNE_SETTLE_MS        400U   /* No detent since then: knob settled, tune */
+#define FM_DIRECTTUNE_DISPLAY_MS       150U   /* Minimum time between two e-paper refreshes */
+
+/**
+ * @brief Init direct tuning, nothing pending
+ */
+void fm_directTune_init(void);
+
+/**
+ * @brief One detent of RE2. Moves target channel, wraps around band limits.
+ *
+ * @param up [in] true to go up in band, false to go down
+ */
+void fm_directTune_step(bool up);
+
+/**
+ * @brief Call it periodically. Shows target frequency and commits the tune
+ * once knob settled.
+ *
+ * @return true   if knob settled and target channel must be tuned now
+ * @return false  otherwise
+ */
+bool fm_directTune_process(void);
+
+/**
+ * @brief Get target channel
+ *
+ * @return uint16_t CHANNEL value of target, see si470x_region.h
+ */
+uint16_t fm_directTune_getTarget(void);
+
+/**
+ * @brief Check if a tune is waiting for knob to settle
+ *
+ * @return true if knob is moving
+ */
+bool fm_directTune_isPending(void);
+
+#endif /* _SI470X_DIRECTTUNE_H_ */
@@ -12,7 +12,7 @@
  */
 #include "si470x_comm.h"
 #include "si470x_driver.h"
-#include <math.h>
+#include "si470x_region.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -30,7 +30,6 @@
  *
  * ______________________________________
  * SHOULD BE CHECKED:
- * - RDSM: RDS mode (verbose or not)
  * - RDSIEN: RDS Interrupt ENable  (on GPIO2)
  * - STCIEN: Seek Tune Complete Interrupt ENable (on GPIO2)
  * 
@@ -60,9 +59,13 @@
 #define SI4703_REG_RDS_SIZE_BYTES   8
 
 #define TUNE_POLL_INTERVAL_MS 20U
+#define TUNE_FAST_POLL_MS     2U   /* Blocking tune, to keep mute window short */
+#define TUNE_TIMEOUT_MS       150U /* Tune lasts 60 ms max. See Si4702/03 datasheet, table 8 */
 #define SEEK_POLL_INTERVAL_MS 200U // relatively large, to reduce electrical interference from I2C
 
-/* ___ Region configurations and sensitivity presets description ____ */
+/* ___ Sensitivity presets description ____ */
+/* Region (band, spacing, de-emphasis) is fixed at compile time, see si470x_region.h.
+ * Sensitivity presets stay in a table: seek sensitivity is adapted at runtime */
 /* SEEKTH, SKSNR, SKCNT */
 static const seekSens_presets_t seekSensPresets[] =
 {{0x19, 0x00, 0x00}, /* FM_SEEK_SENSITIVITY_DEFAULT */
@@ -72,22 +75,42 @@ static const seekSens_presets_t seekSensPresets[] =
  {0x00, 0x04, 0x0F}  /* FM_SEEK_SENSITIVITY_MOST */
 };
 
-/* BOTTOM , TOP */
-static const fm_freqRange_t bandRegions[] = 
-{{87.5f, 108.0f}, /* FM_BAND_USAEUROPE */
- {76.0f, 108.0f}, /* FM_BAND_JAPAN_WIDE */
- {76.0f, 90.0f }    /* FM_BAND_JAPAN */
-};
-
-/* FREQ SPACE */
-static const float spacingRegions[] = 
-{0.2f,   /* FM_CHANNEL_SPACING_200 Americas, South Korea, Australia. */
- 0.1f,   /* FM_CHANNEL_SPACING_100  Europe, Japan. */
- 0.05f,  /* FM_CHANNEL_SPACING_50   Italy. */
-};
-
 /* Handle to Si470x module, gathers all needed info and registers */
 si470x_t _radioHandle;
+/* Updated by si470x_readBlocks(), from main loop or GPIO2 interrupt: never both at once (si470x_comm_isBusy) */
+static volatile si470x_rdsStats_t _rdsStats;
+
+/**
+ * @brief Write SEEKTH, SKSNR and SKCNT of a sensitivity preset to Si470x.
+ * Previous preset bits are cleared first, otherwise switching from one preset
+ * to another would OR both values together.
+ *
+ * @param seek_sensitivity FM_SEEK_SENSITIVITY, preset to write
+ */
+static void si470x_applySeekSensitivity(FM_SEEK_SENSITIVITY seek_sensitivity);
+
+/**
+ * @brief Channel of a frequency in MHz, for CHANNEL register. Integer math on
+ * region constants, frequency is only converted once to kHz.
+ *
+ * @param frequency float, frequency in MHz, must be in band
+ * @return uint16_t channel
+ */
+static inline uint16_t si470x_freqToChannel(float frequency)
+{
+   return SI470X_KHZ_TO_CHANNEL(SI470X_MHZ_TO_KHZ(frequency));
+}
+
+/**
+ * @brief Frequency in MHz of a channel read in READCHAN register
+ *
+ * @param channel uint16_t channel
+ * @return float frequency in MHz
+ */
+static inline float si470x_channelToFreq(uint16_t channel)
+{
+   return (float)SI470X_CHANNEL_TO_KHZ(channel) / 1000.0f;
+}
 
 ///////////////////// PUBLIC FUNCTIONS DEFINITIONS /////////////////////////////
 /* _______________ START AND CONFIG _______________ */
@@ -103,17 +126,17 @@ void si470x_init(void)
    /* reset memory where _radioHandle is placed to 0 */
    memset(&_radioHandle, 0, sizeof(si470x_t));
 
-   /* Set EUROPE configuration */
-   _radioHandle._config.band                 = FM_BAND_USAEUROPE;
-   _radioHandle._config.channel_spacing      = FM_CHANNEL_SPACING_100;
-   _radioHandle._config.deemphasis           = FM_DEEMPHASIS_50;
+   /* Set region configuration, chosen at compile time */
+   _radioHandle._config.band                 = SI470X_BAND;
+   _radioHandle._config.channel_spacing      = SI470X_SPACING;
+   _radioHandle._config.deemphasis           = SI470X_DEEMPHASIS;
    /* Set default FM softmute technic and sensitivity */
-   _radioHandle._config.seek_sensitivity     = FM_SEEK_SENSITIVITY_RECOMMENDED;
+   _radioHandle._config.seek_sensitivity     = SI470X_SEEK_PROFILE;
    _radioHandle._config.softmute_rate        = FM_SOFTMUTE_FASTEST;
    _radioHandle._config.softmute_attenuation = FM_SOFTMUTE_ATTENUATION_16;
 
    /* Set default frequency with region presets as bottom spectrum freq */
-   _radioHandle._freq      = bandRegions[_radioHandle._config.band].bottom;
+   _radioHandle._freq      = si470x_channelToFreq(0x0000);
    _radioHandle._mute      = false;
    _radioHandle._softmute  = true;
    _radioHandle._mono      = true;  /* start in mono, better SNR */
@@ -138,7 +161,7 @@ bool si470x_powerUp(void)
 {
    printf("[FM][DRV] INIT - radio power up\n");
    bool retVal = true;
-   uint16_t readReg[SI470x_REG_BOOTCONFIG];
+   uint16_t readReg[SI470x_REG_MAX];
    uint8_t  DEV_bits   = 0x00;
    uint8_t  index      = 0x00;
 
@@ -179,7 +202,7 @@ bool si470x_powerUp(void)
 
       /* Finish power up sequence by setting the following registers */
       _radioHandle._regs[SI470x_REG_POWERCFG] |= SI470X_MASK_ENABLE	& (1 << SI470X_POS_ENABLE);   
-      _radioHandle._regs[SI470x_REG_POWERCFG] |= SI470X_MASK_DISABLE	& (0 << SI470X_POS_DISABLE);   
+      _radioHandle._regs[SI470x_REG_POWERCFG] &= ~SI470X_MASK_DISABLE;   
       si470x_comm_writeRegisters(&_radioHandle._regs[0], SI470x_REG_POWERCFG);
       sleep_ms(100); // wait for device powerup
    
@@ -216,12 +239,12 @@ bool si470x_configureModule(void)
 {
    printf("[FM][DRV] INIT - radio configure\n");
 
-   uint16_t readReg[SI470x_REG_BOOTCONFIG];
+   uint16_t readReg[SI470x_REG_MAX];
    uint8_t index = 0;
    uint16_t test1TempReg = 0x0000;
    bool retVal = false;
 
-   for(index = 0; index < SI470x_REG_BOOTCONFIG; index++)
+   for(index = 0; index < SI470x_REG_MAX; index++)
    {
       readReg[index] = 0x0000;
    }
@@ -238,7 +261,9 @@ bool si470x_configureModule(void)
 
    /* Start radio output and listening */
    _radioHandle._regs[SI470x_REG_POWERCFG]   |= SI470X_MASK_MONO     & (_radioHandle._mono << SI470X_POS_MONO);
-   _radioHandle._regs[SI470x_REG_POWERCFG]   |= SI470X_MASK_DMUTE    & (_radioHandle._mute << SI470X_POS_DMUTE);
+   _radioHandle._regs[SI470x_REG_POWERCFG]   |= SI470X_MASK_DMUTE    & ((!_radioHandle._mute) << SI470X_POS_DMUTE);
+   /* RDS verbose mode: every group is ready (RDSR), with BLERA-D error levels given to RDS decoder */
+   _radioHandle._regs[SI470x_REG_POWERCFG]   |= SI470X_MASK_RDSM     & (1 << SI470X_POS_RDSM);
    
    /* Activate GPIO2 as interrupt - XOSCEN ERRATA: better use GPIO2 interrupt instead of polling if using internal oscillator */
    _radioHandle._regs[SI470x_REG_SYSCONFIG1] |= SI470X_MASK_RDSIEN   & (1 << SI470X_POS_RDSIEN);
@@ -294,15 +319,14 @@ bool si470x_configureModule(void)
 
 void si470x_powerDown(void) 
 {
-   if(SI470X_STATE_POWERED_UP == _radioHandle._state)
+   if(SI470X_STATE_POWERED_UP <= _radioHandle._state)
    {
-      _radioHandle._regs[SI470x_REG_SYSCONFIG3] |= SI470X_MASK_SMUTER   & ( _radioHandle._config.softmute_rate << SI470X_POS_SMUTER);
-      
       /* For Si4703: Recommended to disable RDS before powering down. See AN230 rev 0.9 */
-      _radioHandle._regs[SI470x_REG_SYSCONFIG1] |= SI470X_MASK_RDS      & (0 << SI470X_POS_RDS);
+      _radioHandle._regs[SI470x_REG_SYSCONFIG1] &= ~SI470X_MASK_RDS;
       si470x_comm_writeRegisters(&_radioHandle._regs[0], SI470x_REG_SYSCONFIG1);
    
-      _radioHandle._regs[SI470x_REG_POWERCFG] |= SI470X_MASK_DMUTE   & (0 << SI470X_POS_DMUTE);
+      /* ENABLE and DISABLE both set: powerdown. DMUTE cleared to avoid a pop */
+      _radioHandle._regs[SI470x_REG_POWERCFG] &= ~SI470X_MASK_DMUTE;
       _radioHandle._regs[SI470x_REG_POWERCFG] |= SI470X_MASK_DISABLE & (1 << SI470X_POS_DISABLE);
    
       si470x_comm_writeRegisters(&_radioHandle._regs[0], SI470x_REG_POWERCFG);
@@ -311,45 +335,147 @@ void si470x_powerDown(void)
    }
 }
 
+bool si470x_resume(void)
+{
+   bool retVal = false;
+   uint32_t startMs = to_ms_since_boot(get_absolute_time());
+
+   if(SI470X_STATE_POWERED_DOWN == _radioHandle._state)
+   {
+      /* Register image as it was before power down */
+      _radioHandle._regs[SI470x_REG_POWERCFG]  &= ~(SI470X_MASK_DISABLE | SI470X_MASK_DMUTE);
+      _radioHandle._regs[SI470x_REG_POWERCFG]  |= SI470X_MASK_ENABLE & (1 << SI470X_POS_ENABLE);
+      _radioHandle._regs[SI470x_REG_POWERCFG]  |= SI470X_MASK_DMUTE  & ((!_radioHandle._mute) << SI470X_POS_DMUTE);
+      _radioHandle._regs[SI470x_REG_SYSCONFIG1] |= SI470X_MASK_RDS   & (1 << SI470X_POS_RDS);
+      _radioHandle._regs[SI470x_REG_CHANNEL]   &= ~SI470X_MASK_TUNE;
+
+      /* POWERCFG up to SYSCONFIG3 in one I2C write */
+      if(si470x_comm_writeRegisters(&_radioHandle._regs[0], SI470x_REG_SYSCONFIG3))
+      {
+         _radioHandle._state = SI470X_STATE_CONFIGURED;
+         retVal = true;
+      }
+      printf("[FM][DRV] Si470x resumed in %lu ms\n", (unsigned long)(to_ms_since_boot(get_absolute_time()) - startMs));
+   }
+   return retVal;
+}
+
 /* _______________ ACTIONS _______________ */
-void si470x_tuneFrequency(float frequency)
+bool si470x_tuneFrequency(float frequency)
 {
    printf("[FM][DRV] Tune freq %f - start\n", frequency);
-   uint16_t tempReg;   /* We read STATUSRSSI only */
+   return si470x_tuneChannel(si470x_freqToChannel(frequency));
+}
+
+bool si470x_tuneChannel(uint16_t channel)
+{
+   uint16_t tempRegs[SI470x_REG_MAX];   /* We read STATUSRSSI only */
    uint8_t bitSTC = 0x01;
+   bool retVal = false;
 
-   if(SI470X_STATE_POWERED_UP <= _radioHandle._state)
+   if((SI470X_STATE_POWERED_UP <= _radioHandle._state) && (SI470X_CHANNEL_MAX >= channel))
    {
       /* Check STC cleared before new seek */
-      si470x_comm_readRegisters(&tempReg, SI470x_REG_STATUSRSSI);
-      bitSTC = (tempReg & SI470X_MASK_STC) >> SI470X_POS_STC;
+      si470x_comm_readRegisters(&tempRegs[0], SI470x_REG_STATUSRSSI);
+      bitSTC = (tempRegs[SI470x_REG_STATUSRSSI] & SI470X_MASK_STC) >> SI470X_POS_STC;
 
-      /* No tune if same freq or if STC not yet cleared */
-      if((_radioHandle._freq != frequency) && (0x00 == bitSTC))
+      /* No tune if STC not yet cleared. Same channel is tuned again, needed after si470x_resume() */
+      if(0x00 == bitSTC)
       {
-         uint16_t channel = (uint16_t)roundf((frequency - bandRegions[_radioHandle._config.band].bottom) 
-                                                     / spacingRegions[_radioHandle._config.channel_spacing]);
-
-         /* Write computed channel to registers and start tuning */
+         /* Write channel to registers and start tuning */
+         _radioHandle._regs[SI470x_REG_CHANNEL] &= ~SI470X_MASK_CHAN;
          _radioHandle._regs[SI470x_REG_CHANNEL] |= SI470X_MASK_CHAN & (channel << SI470X_POS_CHAN);
          _radioHandle._regs[SI470x_REG_CHANNEL] |= SI470X_MASK_TUNE & (1 << SI470X_POS_TUNE);
-         si470x_comm_writeRegisters(&_radioHandle._regs[0], SI470x_REG_CHANNEL);
+         retVal = si470x_comm_writeRegisters(&_radioHandle._regs[0], SI470x_REG_CHANNEL);
+         printf("[FM][DRV] Tune on going...\n");
       }
       else
       {
-         printf("[FM][DRV] Tune failed. STC: %d, Freq: %f | %f\n", bitSTC, frequency, _radioHandle._freq);
+         printf("[FM][DRV] Tune failed. STC: %d, Channel: %d | %d\n", bitSTC, channel, _radioHandle._channel);
       }
    }
    else
    {
-      printf("[FM][DRV] ERROR - No tune possible, Si470x powered down: %d\n", _radioHandle._state);
+      printf("[FM][DRV] ERROR - No tune possible, state: %d, channel: %d\n", _radioHandle._state, channel);
+   }
+   return retVal;
+}
+
+uint8_t si470x_tuneFrequencyBlocking(float frequency)
+{
+   uint16_t tempRegs[SI470x_REG_MAX];   /* We read STATUSRSSI only */
+   uint16_t channel   = 0x0000;
+   uint16_t elapsedMs = 0x0000;
+   uint8_t  rssi      = 0x00;
+   bool     stcSet    = true;
+
+   if((SI470X_STATE_POWERED_UP <= _radioHandle._state)
+   && (SI470X_BAND_BOTTOM_KHZ <= SI470X_MHZ_TO_KHZ(frequency))
+   && (SI470X_BAND_TOP_KHZ    >= SI470X_MHZ_TO_KHZ(frequency)))
+   {
+      channel = si470x_freqToChannel(frequency);
+
+      /* STC of previous seek or tune may still be set for a short while */
+      while((true == stcSet) && (TUNE_TIMEOUT_MS > elapsedMs))
+      {
+         si470x_comm_readRegisters(&tempRegs[0], SI470x_REG_STATUSRSSI);
+         stcSet = (0x00 != (tempRegs[SI470x_REG_STATUSRSSI] & SI470X_MASK_STC));
+         if(true == stcSet)
+         {
+            sleep_ms(TUNE_FAST_POLL_MS);
+            elapsedMs += TUNE_FAST_POLL_MS;
+         }
+      }
+
+      if(false == stcSet)
+      {
+         _radioHandle._regs[SI470x_REG_CHANNEL] &= ~SI470X_MASK_CHAN;
+         _radioHandle._regs[SI470x_REG_CHANNEL] |= SI470X_MASK_CHAN & (channel << SI470X_POS_CHAN);
+         _radioHandle._regs[SI470x_REG_CHANNEL] |= SI470X_MASK_TUNE & (1 << SI470X_POS_TUNE);
+         si470x_comm_writeRegisters(&_radioHandle._regs[0], SI470x_REG_CHANNEL);
+
+         /* Poll STC instead of waiting for GPIO2 */
+         elapsedMs = 0x0000;
+         while((false == stcSet) && (TUNE_TIMEOUT_MS > elapsedMs))
+         {
+            sleep_ms(TUNE_FAST_POLL_MS);
+            elapsedMs += TUNE_FAST_POLL_MS;
+            si470x_comm_readRegisters(&tempRegs[0], SI470x_REG_STATUSRSSI);
+            stcSet = (0x00 != (tempRegs[SI470x_REG_STATUSRSSI] & SI470X_MASK_STC));
+         }
+
+         /* Clears TUNE even on timeout, so that next tune may start */
+         rssi = si470x_seekTune_finished(false);
+         if(false == stcSet)
+         {
+            rssi = 0x00;
+         }
+      }
+   }
+
+   if(0x00 == rssi)
+   {
+      printf("[FM][DRV] Blocking tune to %f failed\n", frequency);
+   }
+   return rssi;
+}
+
+uint8_t si470x_getRSSI(void)
+{
+   uint16_t tempRegs[SI470x_REG_MAX];   /* We read STATUSRSSI only */
+   uint8_t  rssi = 0x00;
+
+   if((SI470X_STATE_POWERED_UP <= _radioHandle._state)
+   && si470x_comm_readRegisters(&tempRegs[0], SI470x_REG_STATUSRSSI))
+   {
+      rssi = (tempRegs[SI470x_REG_STATUSRSSI] & SI470X_MASK_RSSI) >> SI470X_POS_RSSI;
    }
-   printf("[FM][DRV] Tune on going...\n");
+   return rssi;
 }
 
 bool si470x_startSeek(uint8_t direction)
 {
-   uint16_t readReg[SI470x_REG_BOOTCONFIG]; /* We read registers STATUSRSSI and READCHANNEL */
+   uint16_t readReg[SI470x_REG_MAX]; /* We read registers STATUSRSSI and READCHANNEL */
    uint8_t bitSTC = 0x01;
    bool retVal = false;
 
@@ -359,13 +485,13 @@ bool si470x_startSeek(uint8_t direction)
       printf("[FM][DRV] Seek start\n");
       /* @todo STC bit already checked before? */
       /* Check STC cleared before new seek */
-      si470x_comm_readRegisters(&readReg[0], SI470x_REG_READCHAN);
-      bitSTC = (readReg[0] & SI470X_MASK_STC) >> SI470X_POS_STC;
+      si470x_comm_readRegisters(&readReg[0], SI470x_REG_STATUSRSSI);
+      bitSTC = (readReg[SI470x_REG_STATUSRSSI] & SI470X_MASK_STC) >> SI470X_POS_STC;
 
       if(0x00 == bitSTC)
       {
          /* WRAP MODE - Bit SF/BL will be set to 1 if no channel good enough found */
-         _radioHandle._regs[SI470x_REG_POWERCFG] |= SI470X_MASK_SKMODE & (0 << SI470X_POS_SKMODE);
+         _radioHandle._regs[SI470x_REG_POWERCFG] &= ~(SI470X_MASK_SKMODE | SI470X_MASK_SEEKUP);
          /* Set POWERCFG_SEEKUP to high to seek high and to low to seek low */
          _radioHandle._regs[SI470x_REG_POWERCFG] |= SI470X_MASK_SEEKUP & (direction << SI470X_POS_SEEKUP);
          _radioHandle._regs[SI470x_REG_POWERCFG] |= SI470X_MASK_SEEK   & (1 << SI470X_POS_SEEK);
@@ -384,10 +510,32 @@ bool si470x_startSeek(uint8_t direction)
    return retVal;
 }
 
+void si470x_stopSeekTune(void)
+{
+   uint16_t tempRegs[SI470x_REG_MAX];
+   uint16_t channel = 0x0000;
+
+   /* Clearing SEEK stops a seek where it is, clearing TUNE ends a tune */
+   _radioHandle._regs[SI470x_REG_POWERCFG] &= ~SI470X_MASK_SEEK;
+   _radioHandle._regs[SI470x_REG_CHANNEL]  &= ~SI470X_MASK_TUNE;
+   if(!si470x_comm_writeRegisters(&_radioHandle._regs[0], SI470x_REG_CHANNEL))
+   {
+      printf("[FM][DRV] Error while stopping seek/tune\n");
+   }
+
+   /* Stay where seek stopped, next seek continues from there */
+   if(si470x_comm_readRegisters(&tempRegs[0], SI470x_REG_READCHAN))
+   {
+      channel = (tempRegs[SI470x_REG_READCHAN] & SI470X_MASK_READCHAN) >> SI470X_POS_READCHAN;
+      _radioHandle._channel = channel;
+      _radioHandle._freq = si470x_channelToFreq(channel);
+   }
+}
+
 uint8_t si470x_seekTune_finished(bool seekTune)
 {
    printf("[FM][DRV] Seek tune finished\n");
-   uint16_t tempRegs[SI470x_REG_READCHAN+1];   
+   uint16_t tempRegs[SI470x_REG_MAX];
 
    uint8_t SFBL_bit  = 0x00;
    uint8_t ST_bit    = 0x00;
@@ -405,8 +553,8 @@ uint8_t si470x_seekTune_finished(bool seekTune)
       if(seekTune)
       {
          SFBL_bit  = (tempRegs[SI470x_REG_STATUSRSSI] & SI470X_MASK_SFBL) >> SI470X_POS_SFBL;
-         /* End SEEK */
-         _radioHandle._regs[SI470x_REG_POWERCFG] |= SI470X_MASK_SEEK   & (0 << SI470X_POS_SEEK);
+         /* End SEEK, STC is only cleared by Si470x once SEEK bit is cleared */
+         _radioHandle._regs[SI470x_REG_POWERCFG] &= ~SI470X_MASK_SEEK;
          if(!si470x_comm_writeRegisters(&_radioHandle._regs[0], SI470x_REG_POWERCFG))
          {
             printf("[FM][DRV] Error while clearing bit SEEK\n");
@@ -414,8 +562,8 @@ uint8_t si470x_seekTune_finished(bool seekTune)
 
          if(0x01 != SFBL_bit)
          {
-            _radioHandle._freq = channel * spacingRegions[_radioHandle._config.channel_spacing] 
-                                         + bandRegions[_radioHandle._config.band].bottom;
+            _radioHandle._channel = channel;
+            _radioHandle._freq = si470x_channelToFreq(channel);
          }
          else
          {
@@ -426,11 +574,11 @@ uint8_t si470x_seekTune_finished(bool seekTune)
       /* If action was TUNE */
       else
       {
-         _radioHandle._freq = channel * spacingRegions[_radioHandle._config.channel_spacing] 
-                                         + bandRegions[_radioHandle._config.band].bottom;
+         _radioHandle._channel = channel;
+         _radioHandle._freq = si470x_channelToFreq(channel);
 
-         /* End TUNE */
-         _radioHandle._regs[SI470x_REG_CHANNEL] |= SI470X_MASK_TUNE   & (0 << SI470X_POS_TUNE);
+         /* End TUNE, STC is only cleared by Si470x once TUNE bit is cleared */
+         _radioHandle._regs[SI470x_REG_CHANNEL] &= ~SI470X_MASK_TUNE;
          if(!si470x_comm_writeRegisters(&_radioHandle._regs[0], SI470x_REG_CHANNEL))
          {
             printf("[FM][DRV] Error while clearing bit TUNE\n");
@@ -445,21 +593,20 @@ uint8_t si470x_seekTune_finished(bool seekTune)
 }
 
 void si470x_toggleMute(void) 
+{
+   si470x_setMute(!_radioHandle._mute);
+}
+
+void si470x_setMute(bool mute)
 {
    if(_radioHandle._state != SI470X_STATE_POWERED_DOWN) 
    {
-      if (_radioHandle._mute) 
-      {
-         _radioHandle._regs[SI470x_REG_POWERCFG] |= SI470X_MASK_DMUTE & (0 << SI470X_POS_DMUTE);
-         _radioHandle._mute = false;
-      }
-      else
-      {
-         _radioHandle._regs[SI470x_REG_POWERCFG] |= SI470X_MASK_DMUTE & (1 << SI470X_POS_DMUTE);
-         _radioHandle._mute = true;
-      }
+      /* DMUTE is "mute disable": 1 means audio output on */
+      _radioHandle._regs[SI470x_REG_POWERCFG] &= ~SI470X_MASK_DMUTE;
+      _radioHandle._regs[SI470x_REG_POWERCFG] |= SI470X_MASK_DMUTE & ((!mute) << SI470X_POS_DMUTE);
+      _radioHandle._mute = mute;
 
-      printf("[FM][DRV] Mute unmute\n");
+      printf("[FM][DRV] Mute: %d\n", mute);
       si470x_comm_writeRegisters(&_radioHandle._regs[0], SI470x_REG_POWERCFG);
    }
 }
@@ -470,7 +617,7 @@ void si470x_toggleSoftmute(void)
    {
       if (_radioHandle._softmute) 
       {
-         _radioHandle._regs[SI470x_REG_POWERCFG] |= SI470X_MASK_DSMUTE & (0 << SI470X_POS_DSMUTE);
+         _radioHandle._regs[SI470x_REG_POWERCFG] &= ~SI470X_MASK_DSMUTE;
          _radioHandle._softmute = false;
       }
       else
@@ -489,6 +636,7 @@ void si470x_setSoftmuteRate(FM_SOFTMUTE_RATE softmute_rate)
    if( (_radioHandle._state != SI470X_STATE_POWERED_DOWN) 
     && (_radioHandle._config.softmute_rate != softmute_rate))
    {
+      _radioHandle._regs[SI470x_REG_SYSCONFIG3] &= ~SI470X_MASK_SMUTER;
       _radioHandle._regs[SI470x_REG_SYSCONFIG3] |= SI470X_MASK_SMUTER & (softmute_rate << SI470X_POS_SMUTER);
       _radioHandle._config.softmute_rate = softmute_rate;
       si470x_comm_writeRegisters(&_radioHandle._regs[0], SI470x_REG_SYSCONFIG3);
@@ -500,6 +648,7 @@ void si470x_setSoftmuteAttenuation(FM_SOFTMUTE_ATTEN softmute_attenuation)
    if( (_radioHandle._state != SI470X_STATE_POWERED_DOWN) 
     && (_radioHandle._config.softmute_attenuation != softmute_attenuation))
    {
+      _radioHandle._regs[SI470x_REG_SYSCONFIG3] &= ~SI470X_MASK_SMUTEA;
       _radioHandle._regs[SI470x_REG_SYSCONFIG3] |= SI470X_MASK_SMUTEA & (softmute_attenuation << SI470X_POS_SMUTEA);
       _radioHandle._config.softmute_attenuation = softmute_attenuation;
 
@@ -510,16 +659,10 @@ void si470x_setSoftmuteAttenuation(FM_SOFTMUTE_ATTEN softmute_attenuation)
 void si470x_setSeekSensitivity(FM_SEEK_SENSITIVITY seek_sensitivity) 
 {
    if ((_radioHandle._state != SI470X_STATE_POWERED_DOWN) 
+    && (FM_SEEK_SENSITIVITY_MAX > seek_sensitivity)
     && (_radioHandle._config.seek_sensitivity != seek_sensitivity))
    {
-      /* Set corresponding registers for wished sensibility preset (see AN230) */
-      _radioHandle._regs[SI470x_REG_SYSCONFIG2] |= SI470X_MASK_SEEKTH & (seekSensPresets[seek_sensitivity].seekth << SI470X_POS_SEEKTH);
-      _radioHandle._regs[SI470x_REG_SYSCONFIG3] |= SI470X_MASK_SKCNT  & (seekSensPresets[seek_sensitivity].skcnt  << SI470X_POS_SKCNT);
-      _radioHandle._regs[SI470x_REG_SYSCONFIG3] |= SI470X_MASK_SKSNR  & (seekSensPresets[seek_sensitivity].sksnr  << SI470X_POS_SKSNR);      
-      /* Write down to FM module */
-      si470x_comm_writeRegisters(&_radioHandle._regs[0], SI470x_REG_SYSCONFIG3);
-      /* Update shadow registers */
-      _radioHandle._config.seek_sensitivity = seek_sensitivity;
+      si470x_applySeekSensitivity(seek_sensitivity);
    }
 }
 
@@ -531,15 +674,34 @@ void si470x_setSeekSensitivityNext(void)
    {
       /* Go to next sensibility */
       seek_sensitivity = (_radioHandle._config.seek_sensitivity + 1) % FM_SEEK_SENSITIVITY_MAX;
-      /* Set corresponding registers for wished sensibility preset (see AN230) */
-      _radioHandle._regs[SI470x_REG_SYSCONFIG2] |= SI470X_MASK_SEEKTH & (seekSensPresets[seek_sensitivity].seekth << SI470X_POS_SEEKTH);
-      _radioHandle._regs[SI470x_REG_SYSCONFIG3] |= SI470X_MASK_SKCNT  & (seekSensPresets[seek_sensitivity].skcnt << SI470X_POS_SKCNT);
-      _radioHandle._regs[SI470x_REG_SYSCONFIG3] |= SI470X_MASK_SKSNR  & (seekSensPresets[seek_sensitivity].sksnr << SI470X_POS_SKSNR);      
+      si470x_applySeekSensitivity(seek_sensitivity);
+   }
+}
 
-      /* Write down to FM module */
-      si470x_comm_writeRegisters(&_radioHandle._regs[0], SI470x_REG_SYSCONFIG3);
-      /* Update shadow registers */
-      _radioHandle._config.seek_sensitivity = seek_sensitivity;
+static void si470x_applySeekSensitivity(FM_SEEK_SENSITIVITY seek_sensitivity)
+{
+   /* Clear previous preset bits */
+   _radioHandle._regs[SI470x_REG_SYSCONFIG2] &= ~SI470X_MASK_SEEKTH;
+   _radioHandle._regs[SI470x_REG_SYSCONFIG3] &= ~(SI470X_MASK_SKCNT | SI470X_MASK_SKSNR);
+
+   /* Set corresponding registers for wished sensibility preset (see AN230) */
+   _radioHandle._regs[SI470x_REG_SYSCONFIG2] |= SI470X_MASK_SEEKTH & (seekSensPresets[seek_sensitivity].seekth << SI470X_POS_SEEKTH);
+   _radioHandle._regs[SI470x_REG_SYSCONFIG3] |= SI470X_MASK_SKCNT  & (seekSensPresets[seek_sensitivity].skcnt  << SI470X_POS_SKCNT);
+   _radioHandle._regs[SI470x_REG_SYSCONFIG3] |= SI470X_MASK_SKSNR  & (seekSensPresets[seek_sensitivity].sksnr  << SI470X_POS_SKSNR);
+
+   /* Write down to FM module */
+   si470x_comm_writeRegisters(&_radioHandle._regs[0], SI470x_REG_SYSCONFIG3);
+   /* Update shadow registers */
+   _radioHandle._config.seek_sensitivity = seek_sensitivity;
+}
+
+void si470x_setRDSInterrupt(bool enable)
+{
+   if(SI470X_STATE_POWERED_UP <= _radioHandle._state)
+   {
+      _radioHandle._regs[SI470x_REG_SYSCONFIG1] &= ~SI470X_MASK_RDSIEN;
+      _radioHandle._regs[SI470x_REG_SYSCONFIG1] |= SI470X_MASK_RDSIEN & (enable << SI470X_POS_RDSIEN);
+      si470x_comm_writeRegisters(&_radioHandle._regs[0], SI470x_REG_SYSCONFIG1);
    }
 }
 
@@ -548,6 +710,7 @@ void si470x_setMonoStereo(bool mono)
    if( (_radioHandle._state != SI470X_STATE_POWERED_DOWN) 
     && (_radioHandle._mono != mono))
    {
+      _radioHandle._regs[SI470x_REG_POWERCFG] &= ~SI470X_MASK_MONO;
       _radioHandle._regs[SI470x_REG_POWERCFG] |= SI470X_MASK_MONO & (mono << SI470X_POS_MONO);
       _radioHandle._mono = mono;
 
@@ -562,6 +725,8 @@ void si470x_setVolume(uint8_t volume, bool volext)
       /* Avoid volume higher than Si470x max volume */
       volume = MIN(volume, SI4703_MAX_VOLUME);
 
+      _radioHandle._regs[SI470x_REG_SYSCONFIG2] &= ~SI470X_MASK_VOLUME;
+      _radioHandle._regs[SI470x_REG_SYSCONFIG3] &= ~SI470X_MASK_VOLEXT;
       _radioHandle._regs[SI470x_REG_SYSCONFIG2] |= SI470X_MASK_VOLUME & (volume << SI470X_POS_VOLUME);
       _radioHandle._regs[SI470x_REG_SYSCONFIG3] |= SI470X_MASK_VOLEXT & (volext << SI470X_POS_VOLEXT);
       _radioHandle._volume = volume;
@@ -573,31 +738,75 @@ void si470x_setVolume(uint8_t volume, bool volext)
 }
 
 /* _______________ GETTERS _______________ */
-void si470x_getBlocks(rds_groupBlocks* ptrToBlocks)
+bool si470x_getBlocks(rds_groupBlocks* ptrToBlocks)
 {
-   uint16_t upperRegs[0x06]; /* Only upper registers 0Ah to 0Fh */
+   bool retVal = si470x_readBlocks(ptrToBlocks, NULL);
 
-   if(si470x_comm_readRegisters(&upperRegs[0], SI470x_REG_RDSD))
+   if(false == retVal)
    {
-      /* Check if RDS ready*/
-      if(0x01 == (upperRegs[0] & SI470X_MASK_RDSR) >> SI470X_POS_RDSR)
-      {
-         /* Two first registers 0Ah and 0Bh don´t have RDS data */
-         ptrToBlocks->block_A = upperRegs[2];
-         ptrToBlocks->block_B = upperRegs[3];
-         ptrToBlocks->block_C = upperRegs[4];
-         ptrToBlocks->block_D = upperRegs[5];
-      }
-      else
+      printf("[FM][DRV] RDSR not ready\n");
+   }
+   return retVal;
+}
+
+bool si470x_readBlocks(rds_groupBlocks* ptrToBlocks, uint8_t *rssi)
+{
+   uint16_t upperRegs[SI470x_REG_MAX]; /* Only upper registers 0Ah to 0Fh are read */
+   bool retVal = false;
+
+   _rdsStats._reads++;
+   /* Check if RDS ready*/
+   if(false == si470x_comm_readRegisters(&upperRegs[0], SI470x_REG_RDSD))
+   {
+      _rdsStats._errors++;
+   }
+   else if(0x00 == ((upperRegs[SI470x_REG_STATUSRSSI] & SI470X_MASK_RDSR) >> SI470X_POS_RDSR))
+   {
+      _rdsStats._notReady++;
+   }
+   else
+   {
+      /* Two first registers 0Ah and 0Bh don´t have RDS data */
+      ptrToBlocks->block_A = upperRegs[SI470x_REG_RDSA];
+      ptrToBlocks->block_B = upperRegs[SI470x_REG_RDSB];
+      ptrToBlocks->block_C = upperRegs[SI470x_REG_RDSC];
+      ptrToBlocks->block_D = upperRegs[SI470x_REG_RDSD];
+      /* Verbose mode: errors corrected per block, RDS_BLER_UNCORRECTABLE blocks are rejected by decoder */
+      ptrToBlocks->bler_A  = (upperRegs[SI470x_REG_STATUSRSSI] & SI470X_MASK_BLERA) >> SI470X_POS_BLERA;
+      ptrToBlocks->bler_B  = (upperRegs[SI470x_REG_READCHAN]   & SI470X_MASK_BLERB) >> SI470X_POS_BLERB;
+      ptrToBlocks->bler_C  = (upperRegs[SI470x_REG_READCHAN]   & SI470X_MASK_BLERC) >> SI470X_POS_BLERC;
+      ptrToBlocks->bler_D  = (upperRegs[SI470x_REG_READCHAN]   & SI470X_MASK_BLERD) >> SI470X_POS_BLERD;
+      if(NULL != rssi)
       {
-         printf("[FM][DRV] RDSR not ready: %d", ((upperRegs[0] & SI470X_MASK_RDSR) >> SI470X_POS_RDSR));
+         *rssi = (uint8_t)((upperRegs[SI470x_REG_STATUSRSSI] & SI470X_MASK_RSSI) >> SI470X_POS_RSSI);
       }
+      retVal = true;
    }
+   return retVal;
+}
+
+void si470x_getRdsStats(si470x_rdsStats_t *stats)
+{
+   stats->_reads    = _rdsStats._reads;
+   stats->_notReady = _rdsStats._notReady;
+   stats->_errors   = _rdsStats._errors;
+}
+
+bool si470x_isSeekTuneComplete(void)
+{
+   uint16_t tempRegs[SI470x_REG_MAX];
+   bool retVal = false;
+
+   if(si470x_comm_readRegisters(&tempRegs[0], SI470x_REG_STATUSRSSI))
+   {
+      retVal = (0x00 != (tempRegs[SI470x_REG_STATUSRSSI] & SI470X_MASK_STC));
+   }
+   return retVal;
 }
 
 bool si470x_getSTCbit(void)
 {
-   uint16_t tempRegs[SI470x_REG_STATUSRSSI+1];   
+   uint16_t tempRegs[SI470x_REG_MAX];
    bool retVal = false;
    uint8_t STC_bit = 0x00;
 
@@ -639,7 +848,10 @@ bool si470x_getMute(void)
 { return _radioHandle._mute; }
 
 bool si470x_isPoweredUp(void)
-{ return (_radioHandle._state == SI470X_STATE_POWERED_UP) ? true : false; }
+{ return (SI470X_STATE_POWERED_UP <= _radioHandle._state) ? true : false; }
+
+SI470X_STATE si470x_getState(void)
+{ return _radioHandle._state; }
 
 fm_config_t si470x_getConfig(void)
 { return _radioHandle._config; }
@@ -649,3 +861,6 @@ FM_SEEK_SENSITIVITY si470x_getSeekSensitivity(void)
 
 float si470x_getFrequency(void)
 { return _radioHandle._freq; }
+
+uint16_t si470x_getChannel(void)
+{ return _radioHandle._channel; }
@@ -50,26 +50,19 @@ typedef enum {
 
 /**
  * @brief State of FM radio module
- * State machine to allow or refuse commands done on the API
+ * State machine to allow or refuse commands done on the API.
+ * Order matters: from POWERED_UP, Si470x accepts seek and tune.
  */
 typedef enum {
-   SI470X_STATE_POWERED_DOWN,
+   SI470X_STATE_INITIALIZED = 0, /* Driver ready, Si470x never powered up (cold) */
+   SI470X_STATE_POWERED_DOWN,    /* Standby: oscillator running and registers kept (warm) */
    SI470X_STATE_POWERED_UP,
-   SI470X_STATE_INITIALIZED,
    SI470X_STATE_CONFIGURED
 } SI470X_STATE;
 
-/**
- * @brief Frequency range in MHz corresponding to an FM_BAND.
- */
-typedef struct {
-   float bottom;
-   float top;
-} fm_freqRange_t;
-
 /**
  * @brief Physical configuration of FM module. 
- * Values of the configuration should be adapted depending on the region
+ * Region values are set from si470x_region.h, chosen at compile time
  */
 typedef struct {
    FM_SEEK_SENSITIVITY  seek_sensitivity;
@@ -100,6 +93,7 @@ typedef struct {
    SI470X_STATE   _state;     /* State of module, works like a state machine */
    fm_config_t       _config;       /* Si470x FM configuration */
    float             _freq;         /* actual frequency of radio */
+   uint16_t          _channel;      /* actual channel of radio (READCHAN) */
    bool              _mute;         /* output audio: mute radio sound (off) */
    bool              _softmute;     /* activate soft mute or not (SNR) */
    bool              _mono;         /* avtivate mono or stereo, better SNR if in mono */
@@ -108,10 +102,14 @@ typedef struct {
    uint16_t          _regs[SI470x_REG_MAX];
 } si470x_t;
 
-/* ___ Region configurations and sensitivity presets description ____ */
-static const seekSens_presets_t seekSensPresets[FM_SEEK_SENSITIVITY_MAX];
-static const fm_freqRange_t bandRegions[FM_BAND_MAX];
-static const float spacingRegions[FM_CHANNEL_SPACING_MAX];
+/**
+ * @brief Counters of RDS group reads, see si470x_readBlocks()
+ */
+typedef struct {
+   uint32_t _reads;        /* Reads of RDS registers */
+   uint32_t _notReady;     /* Reads without RDSR: STC interrupt, or group already read */
+   uint32_t _errors;       /* I2C errors */
+} si470x_rdsStats_t;
 
 /* ___ GETTERS ___ */
 uint8_t si470x_getVolume(void);
@@ -122,9 +120,11 @@ FM_SOFTMUTE_RATE si470x_getSoftmuteRate(void);
 bool si470x_getSoftmute(void);
 bool si470x_getMute(void);
 bool si470x_isPoweredUp(void);
+SI470X_STATE si470x_getState(void);
 fm_config_t si470x_getConfig(void);
 FM_SEEK_SENSITIVITY si470x_getSeekSensitivity(void);
 float si470x_getFrequency(void);
+uint16_t si470x_getChannel(void);
 
 /* ______________ Start Si4703 FM module  ______________ */
 
@@ -152,9 +152,21 @@ bool si470x_configureModule(void);
 /**
  * @brief Power down the radio chip.
  * Puts the chip in a low power state while maintaining register configuration.
+ * Crystal oscillator keeps running (XOSCEN is untouched), so that
+ * si470x_resume() doesn't need to wait for its stabilization.
  */
 void si470x_powerDown(void);
 
+/**
+ * @brief Warm power up, after si470x_powerDown(). Shadow registers are
+ * written back in one burst with ENABLE set, no reset sequence and no wait
+ * for oscillator. Actual frequency must be tuned again to have audio.
+ * 
+ * @return true   if Si470x is configured again
+ * @return false  if it was not powered down by si470x_powerDown(), use si470x_powerUp()
+ */
+bool si470x_resume(void);
+
 /* ______________ Trivial setters  ______________ */
 
 /**
@@ -174,6 +186,13 @@ void si470x_setSeekSensitivityNext(void);
  */
 void si470x_toggleMute(void);
 
+/**
+ * @brief mute or unmute output volume
+ *
+ * @param mute  bool, true to mute
+ */
+void si470x_setMute(bool mute);
+
 /**
  * @brief toggle softmure of Si470x
  * Softmute is a feature in case of bad signal
@@ -194,6 +213,14 @@ void si470x_setSoftmuteRate(FM_SOFTMUTE_RATE softmute_rate);
  */
 void si470x_setSoftmuteAttenuation(FM_SOFTMUTE_ATTEN softmute_attenuation);
 
+/**
+ * @brief Enable or disable GPIO2 interrupt on each new RDS group (RDSIEN).
+ * RDS is still decoded by Si470x, groups may be polled with si470x_getBlocks().
+ * 
+ * @param enable bool, true to get an interrupt per RDS group
+ */
+void si470x_setRDSInterrupt(bool enable);
+
 /**
  * @brief Set mono or stereo FM decoding. Les SNR with stereo
  * 
@@ -217,6 +244,15 @@ void si470x_setVolume(uint8_t volume, bool volext);
  */
 bool si470x_getSTCbit(void);
 
+/**
+ * @brief return STC bit status, to poll end of seek or tune when GPIO2
+ * interrupt was lost
+ * 
+ * @return true   STC bit is set, seek or tune is complete
+ * @return false  seek or tune still on going (or registers not readable)
+ */
+bool si470x_isSeekTuneComplete(void);
+
 /* _______________ GPIO2 callback after long task finished  _______________ */
 
 /**
@@ -231,9 +267,29 @@ uint8_t si470x_seekTune_finished(bool seekTune);
 /**
  * @brief Get actual RDS blocks
  * 
- * @param ptrToBlocks 
+ * @param ptrToBlocks [out] blocks A to D, untouched if no group ready
+ * @return true       if a new group was ready (RDSR)
+ * @return false      if not, GPIO2 interrupt was an STC one
  */
-void si470x_getBlocks(rds_groupBlocks* ptrToBlocks);
+bool si470x_getBlocks(rds_groupBlocks* ptrToBlocks);
+
+/**
+ * @brief Same as si470x_getBlocks(), without any print: may be called from
+ * GPIO2 interrupt, once si470x_comm_isBusy() checked
+ * 
+ * @param ptrToBlocks [out] blocks A to D, untouched if no group ready
+ * @param rssi        [out] RSSI read with the group, may be NULL
+ * @return true       if a new group was ready (RDSR)
+ * @return false      if not, or I2C error
+ */
+bool si470x_readBlocks(rds_groupBlocks* ptrToBlocks, uint8_t *rssi);
+
+/**
+ * @brief Get counters of RDS group reads, since power up
+ * 
+ * @param stats [out] counters
+ */
+void si470x_getRdsStats(si470x_rdsStats_t *stats);
 
 /* ______________ Long tasks, may be blocking or asynchronous  ______________ */
 /**
@@ -241,9 +297,35 @@ void si470x_getBlocks(rds_groupBlocks* ptrToBlocks);
  * May be either blocking: will poll Si470x 0Ah buffer until STC bit is set
  * Or may not be blocking, set SEEK_TUNE state machine to BUSY, until GPIO2 interrupt occurs
  * @param frequency  float, frequency to set in MHz
- * @param blocking   true: polling, false: with GPIO2 interrupt
+ * @return true      if tune started, end is notified by STC
+ * @return false     if not started: STC not yet cleared or powered down
+ */
+bool si470x_tuneFrequency(float frequency);
+
+/**
+ * @brief Tune a channel already computed, e.g. stored in a preset. Same as
+ * si470x_tuneFrequency(), without any frequency conversion: one CHANNEL write.
+ * @param channel    uint16_t, CHANNEL value, see si470x_region.h
+ * @return true      if tune started, end is notified by STC
+ * @return false     if not started: STC not yet cleared, powered down or out of band
  */
-void si470x_tuneFrequency(float frequency);
+bool si470x_tuneChannel(uint16_t channel);
+
+/**
+ * @brief Tune a frequency and wait for the end of tune by polling STC, without
+ * GPIO2. Used to check alternative frequencies quickly, while audio is muted.
+ * 
+ * @param frequency  float, frequency to set in MHz
+ * @return uint8_t   RSSI of frequency, 0 if tune failed or frequency out of band
+ */
+uint8_t si470x_tuneFrequencyBlocking(float frequency);
+
+/**
+ * @brief Read actual RSSI (STATUSRSSI register)
+ * 
+ * @return uint8_t RSSI in dBµV, 0 if not readable
+ */
+uint8_t si470x_getRSSI(void);
 
 /**
  * @brief Start a seek, up or down
@@ -253,6 +335,13 @@ void si470x_tuneFrequency(float frequency);
  */
 bool si470x_startSeek(uint8_t direction);
 
+/**
+ * @brief Stop a seek or tune on going by clearing SEEK and TUNE bits. Actual
+ * channel is read back, as a stopped seek stays where it was.
+ * Wait for STC to be cleared before starting a new seek or tune.
+ */
+void si470x_stopSeekTune(void);
+
 #ifdef __cplusplus
 }
 #endif
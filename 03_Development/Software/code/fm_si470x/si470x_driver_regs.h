@@ -187,7 +187,7 @@ typedef enum {
 #define SI470X_POS_VOLEXT     8U
 #define SI470X_MASK_SMUTEA    0x3000
 #define SI470X_POS_SMUTEA     12U
-#define SI470X_MASK_SMUTER    0xF000
+#define SI470X_MASK_SMUTER    0xC000
 #define SI470X_POS_SMUTER     14U
 
 /* Register 0x07 -   TEST1
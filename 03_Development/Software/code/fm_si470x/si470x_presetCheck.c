@@ -0,0 +1,228 @@
+/**
+ * @file    si470x_presetCheck.c
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Background preset health check. See si470x_presetCheck.h
+ *
+ *          WAIT --(period elapsed, Si470x in standby)--> resume muted, TUNE
+ *          TUNE --(blocking tune of preset)-------------> LISTEN
+ *          LISTEN --(PS complete, or listen timeout)----> TUNE next preset
+ *          TUNE --(all presets done)--------------------> tune back, standby, WAIT
+ * @version 0.1
+ * @date    2023-09-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "si470x_presetCheck.h"
+#include "si470x_rdsRing.h"
+#include "si470x_rdsService.h"
+#include "rdsCache.h"
+
+static FM_PRESETCHECK_STATE _state;
+static uint32_t _lastCheckMs;    /* End of last check, or init */
+static uint32_t _waitMs;         /* Time to wait from _lastCheckMs for next check */
+static uint32_t _stateStartMs;   /* Time of entry in actual state */
+static uint32_t _lastPollMs;     /* Time of last RDS group poll */
+static uint8_t  _index;          /* Preset checked */
+static float    _originalFreq;   /* Station of Si470x before check */
+static bool     _originalMute;   /* Mute of Si470x before check */
+static bool     _changed;        /* Presets changed during check */
+
+/**
+ * @brief Resume Si470x muted and start with first preset
+ */
+static bool fm_presetCheck_start(void);
+
+/**
+ * @brief Preset listened to: update its RSSI, PS name and dead flag
+ */
+static void fm_presetCheck_update(fm_station_preset *preset, uint8_t rssi, const uint8_t *psName, bool psComplete);
+
+/**
+ * @brief Tune back to original station, restore mute and put Si470x in standby
+ */
+static void fm_presetCheck_stop(void);
+
+void fm_presetCheck_init(void)
+{
+   _state        = FM_PRESETCHECK_STATE_WAIT;
+   _lastCheckMs  = to_ms_since_boot(get_absolute_time());
+   _waitMs       = FM_PRESETCHECK_START_DELAY_MS;
+   _stateStartMs = _lastCheckMs;
+   _lastPollMs   = _lastCheckMs;
+   _index        = 0x00;
+   _changed      = false;
+}
+
+bool fm_presetCheck_process(fm_station_preset *presets, uint8_t count)
+{
+   uint32_t nowMs = to_ms_since_boot(get_absolute_time());
+   bool     psComplete = false;
+   bool     retVal     = false;
+   rds_groupBlocks group;
+   fm_rdsSnapshot  snapshot;
+
+   switch(_state)
+   {
+      case FM_PRESETCHECK_STATE_WAIT:
+         if((true == fm_presetCheck_isDue())
+         && (SI470X_STATE_POWERED_DOWN == si470x_getState())
+         && (0 < count))
+         {
+            if(true == fm_presetCheck_start())
+            {
+               _state = FM_PRESETCHECK_STATE_TUNE;
+            }
+            else
+            {
+               _lastCheckMs = nowMs;
+               _waitMs      = FM_PRESETCHECK_PERIOD_MS;
+            }
+         }
+         break;
+
+      case FM_PRESETCHECK_STATE_TUNE:
+         if(_index < count)
+         {
+            /* A weak or empty preset needs no RDS listening */
+            fm_rdsService_newStation();
+            presets[_index].preset_rssi = si470x_tuneFrequencyBlocking(presets[_index].preset_freq);
+            _state        = FM_PRESETCHECK_STATE_LISTEN;
+            _stateStartMs = nowMs;
+            _lastPollMs   = nowMs;
+            if(FM_PRESETCHECK_DEAD_RSSI > presets[_index].preset_rssi)
+            {
+               fm_presetCheck_update(&presets[_index], presets[_index].preset_rssi, NULL, false);
+               _index++;
+               _state = FM_PRESETCHECK_STATE_TUNE;
+            }
+         }
+         else
+         {
+            printf("[FM][PRESETCHECK] All presets checked\n");
+            fm_presetCheck_stop();
+            retVal = _changed;
+         }
+         break;
+
+      case FM_PRESETCHECK_STATE_LISTEN:
+         if(FM_PRESETCHECK_POLL_MS <= (nowMs - _lastPollMs))
+         {
+            _lastPollMs = nowMs;
+            /* Decoded by RDS service on core1 */
+            if(true == si470x_getBlocks(&group))
+            {
+               fm_rdsRing_push(&group);
+            }
+         }
+
+         /* Snapshot of previous preset is not complete */
+         psComplete = (true == fm_rdsService_getSnapshot(&snapshot)) && (true == snapshot._psComplete);
+         if((true == psComplete) || (FM_PRESETCHECK_LISTEN_MS <= (nowMs - _stateStartMs)))
+         {
+            if((true == psComplete) && (RDS_CACHE_PI_UNKNOWN != snapshot._pi))
+            {
+               rdsCache_storePS(snapshot._pi, si470x_getChannel(), &snapshot._psName[0], snapshot._pty);
+            }
+            fm_presetCheck_update(&presets[_index], presets[_index].preset_rssi, &snapshot._psName[0], psComplete);
+            _index++;
+            _state = FM_PRESETCHECK_STATE_TUNE;
+         }
+         break;
+
+      default:
+         _state = FM_PRESETCHECK_STATE_WAIT;
+         break;
+   }
+   return retVal;
+}
+
+void fm_presetCheck_abort(void)
+{
+   if(FM_PRESETCHECK_STATE_WAIT != _state)
+   {
+      printf("[FM][PRESETCHECK] Aborted at preset %d\n", _index);
+      fm_presetCheck_stop();
+   }
+}
+
+bool fm_presetCheck_isDue(void)
+{
+   /* First check waits for START_DELAY only, next ones for a full period */
+   return (FM_PRESETCHECK_STATE_WAIT == _state)
+       && (_waitMs <= (to_ms_since_boot(get_absolute_time()) - _lastCheckMs));
+}
+
+bool fm_presetCheck_isRunning(void)
+{
+   return (FM_PRESETCHECK_STATE_WAIT != _state);
+}
+
+static bool fm_presetCheck_start(void)
+{
+   bool retVal = false;
+
+   _originalFreq = si470x_getFrequency();
+   _originalMute = si470x_getMute();
+
+   if(true == si470x_resume())
+   {
+      printf("[FM][PRESETCHECK] Start\n");
+      si470x_setMute(true);
+      _index   = 0x00;
+      _changed = false;
+      retVal   = true;
+   }
+   return retVal;
+}
+
+static void fm_presetCheck_update(fm_station_preset *preset, uint8_t rssi, const uint8_t *psName, bool psComplete)
+{
+   bool dead = false;
+
+   if(FM_PRESETCHECK_DEAD_RSSI > rssi)
+   {
+      if(FM_PRESETCHECK_DEAD_CHECKS > preset->preset_weakChecks)
+      {
+         preset->preset_weakChecks++;
+      }
+   }
+   else
+   {
+      preset->preset_weakChecks = 0x00;
+   }
+
+   dead = (FM_PRESETCHECK_DEAD_CHECKS <= preset->preset_weakChecks);
+   if(dead != preset->preset_dead)
+   {
+      preset->preset_dead = dead;
+      _changed = true;
+   }
+
+   if((true == psComplete) && (0 != memcmp(&preset->preset_PSname[0], psName, PS_GROUP_MAX_CHARS)))
+   {
+      memcpy(&preset->preset_PSname[0], psName, PS_GROUP_MAX_CHARS);
+      preset->preset_PSname[PS_GROUP_MAX_CHARS] = '\0';
+      _changed = true;
+   }
+
+   printf("[FM][PRESETCHECK] Preset %d: %f, RSSI %d, %s%s\n", _index, preset->preset_freq, rssi,
+          preset->preset_PSname, (true == preset->preset_dead) ? ", dead" : "");
+}
+
+static void fm_presetCheck_stop(void)
+{
+   /* Same station as before check for next resume, audio as user left it */
+   si470x_tuneFrequencyBlocking(_originalFreq);
+   si470x_setMute(_originalMute);
+   fm_rdsService_newStation();
+   si470x_powerDown();
+
+   _state       = FM_PRESETCHECK_STATE_WAIT;
+   _lastCheckMs = to_ms_since_boot(get_absolute_time());
+   _waitMs      = FM_PRESETCHECK_PERIOD_MS;
+}
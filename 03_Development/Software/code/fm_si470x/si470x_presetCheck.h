@@ -0,0 +1,79 @@
+/**
+ * @file    si470x_presetCheck.h
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Background preset health check. While FM is not the active mode
+ *          (radio in BT or IDLE mode), Si470x sits in standby. From time to
+ *          time it is resumed muted, each preset is tuned and listened to for
+ *          a short while:
+ *             - RSSI of preset is refreshed
+ *             - PS name of preset is refreshed from RDS (and RDS cache)
+ *             - a preset found too weak FM_PRESETCHECK_DEAD_CHECKS times in a
+ *               row is flagged dead, preset recall skips it
+ *          Si470x is tuned back to its station and put in standby again. Check
+ *          is aborted as soon as FM is activated, or Si470x is used otherwise.
+ *          Check needs Si470x in warm standby. After a boot in BT mode, FM
+ *          application powers it up once when first check is due.
+ * @version 0.1
+ * @date    2023-09-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _SI470X_PRESETCHECK_H_
+#define _SI470X_PRESETCHECK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "si470x_driver.h"
+#include "si470x_application.h"
+
+#define FM_PRESETCHECK_START_DELAY_MS  10000U    /* FM inactive since then before first check, mode switches are not disturbed */
+#define FM_PRESETCHECK_PERIOD_MS       900000U   /* One check of all presets every 15 minutes */
+#define FM_PRESETCHECK_LISTEN_MS       3000U     /* RDS listening per preset, PS needs 4 groups at ~11 groups/s */
+#define FM_PRESETCHECK_POLL_MS         40U       /* RDS group polling, no GPIO2 interrupt while FM inactive */
+#define FM_PRESETCHECK_DEAD_RSSI       15U       /* dBµV, preset under it does not come in */
+#define FM_PRESETCHECK_DEAD_CHECKS     2U        /* Weak checks in a row before flagging dead, a single fade is not enough */
+
+typedef enum {
+   FM_PRESETCHECK_STATE_WAIT = 0,   /* Wait for next check */
+   FM_PRESETCHECK_STATE_TUNE,       /* Tune next preset */
+   FM_PRESETCHECK_STATE_LISTEN      /* Poll RDS groups of tuned preset */
+} FM_PRESETCHECK_STATE;
+
+/**
+ * @brief Init check, first one after FM_PRESETCHECK_START_DELAY_MS
+ */
+void fm_presetCheck_init(void);
+
+/**
+ * @brief Run check. Call it periodically while FM is not the active mode.
+ *
+ * @param presets  [in/out] station presets, RSSI, PS name and state are updated
+ * @param count    [in] number of presets
+ * @return true    if a PS name or a dead flag changed, presets are worth saving
+ * @return false   otherwise
+ */
+bool fm_presetCheck_process(fm_station_preset *presets, uint8_t count);
+
+/**
+ * @brief Check if next check may start, Si470x in standby or not
+ *
+ * @return true if waiting time is over
+ */
+bool fm_presetCheck_isDue(void);
+
+/**
+ * @brief Stop a check on going: Si470x is tuned back to its station, unmuted
+ * as before and put in standby again. Call it before using Si470x.
+ */
+void fm_presetCheck_abort(void);
+
+/**
+ * @brief Check if Si470x is used by a check
+ *
+ * @return true if a check is on going
+ */
+bool fm_presetCheck_isRunning(void);
+
+#endif /* _SI470X_PRESETCHECK_H_ */
@@ -0,0 +1,109 @@
+/**
+ * @file    si470x_rdsGate.c
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   RDS interrupt gating. See si470x_rdsGate.h
+ * @version 0.1
+ * @date    2023-09-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "si470x_rdsGate.h"
+
+static bool     _gated;          /* RDS interrupt disabled */
+static bool     _rtConfirmed;    /* An RT message was completed since last A/B change */
+static bool     _abKnown;        /* At least one RT group received */
+static uint8_t  _abFlag;         /* A/B flag of last RT */
+static uint32_t _gatedAtMs;      /* Time at which interrupt was disabled */
+static uint32_t _lastPollMs;     /* Time of last group polled while gated */
+
+/**
+ * @brief Enable or disable RDS interrupt
+ */
+static void fm_rdsGate_set(bool gated);
+
+void fm_rdsGate_init(void)
+{
+   _gated = false;
+   fm_rdsGate_newStation();
+}
+
+void fm_rdsGate_newStation(void)
+{
+   _rtConfirmed = false;
+   _abKnown     = false;
+   _abFlag      = 0x00;
+   if(true == _gated)
+   {
+      fm_rdsGate_set(false);
+   }
+}
+
+void fm_rdsGate_group(bool rtGroup, uint8_t abFlag, bool psComplete, bool rtComplete)
+{
+   if((true == rtGroup) && (true == _abKnown) && (abFlag != _abFlag))
+   {
+      /* New RT on air, wait until it is confirmed too */
+      _rtConfirmed = false;
+      if(true == _gated)
+      {
+         printf("[FM][GATE] RT A/B changed\n");
+         fm_rdsGate_set(false);
+      }
+   }
+
+   if(true == rtGroup)
+   {
+      _abFlag  = abFlag;
+      _abKnown = true;
+   }
+
+   if(true == rtComplete)
+   {
+      _rtConfirmed = true;
+   }
+
+   if((false == _gated) && (true == psComplete) && (true == _rtConfirmed))
+   {
+      fm_rdsGate_set(true);
+   }
+}
+
+bool fm_rdsGate_process(rds_groupBlocks *group)
+{
+   bool     retVal = false;
+   uint32_t nowMs  = to_ms_since_boot(get_absolute_time());
+
+   if(true == _gated)
+   {
+      if(FM_RDS_GATE_REFRESH_MS <= (nowMs - _gatedAtMs))
+      {
+         /* Full RDS again for a while, PS and RT are confirmed again before gating */
+         _rtConfirmed = false;
+         fm_rdsGate_set(false);
+      }
+      else if(FM_RDS_GATE_POLL_MS <= (nowMs - _lastPollMs))
+      {
+         _lastPollMs = nowMs;
+         retVal = si470x_getBlocks(group);
+      }
+   }
+   return retVal;
+}
+
+bool fm_rdsGate_isGated(void)
+{
+   return _gated;
+}
+
+static void fm_rdsGate_set(bool gated)
+{
+   si470x_setRDSInterrupt(!gated);
+   _gated      = gated;
+   _gatedAtMs  = to_ms_since_boot(get_absolute_time());
+   _lastPollMs = _gatedAtMs;
+   printf("[FM][GATE] RDS interrupt %s\n", gated ? "off" : "on");
+}
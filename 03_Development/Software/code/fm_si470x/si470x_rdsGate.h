@@ -0,0 +1,69 @@
+/**
+ * @file    si470x_rdsGate.h
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   RDS interrupt gating. With RDSIEN set, GPIO2 fires on each RDS
+ *          group (~11 per second) and each one costs an I2C read of 12 bytes.
+ *          Once PS name and RT message of a station are confirmed at the
+ *          configured RT_QUALITY_STATE, RDS interrupt is disabled. Then:
+ *             - one group is polled every FM_RDS_GATE_POLL_MS, if it is an RT
+ *               group with another A/B flag, a new RT is on air: interrupt is
+ *               enabled again
+ *             - after FM_RDS_GATE_REFRESH_MS, interrupt is enabled again anyway,
+ *               to catch PS or RT changes missed by polling
+ * @version 0.1
+ * @date    2023-09-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _SI470X_RDSGATE_H_
+#define _SI470X_RDSGATE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "si470x_driver.h"
+
+#define FM_RDS_GATE_POLL_MS     1000U   /* One group read per second while gated, instead of ~11 */
+#define FM_RDS_GATE_REFRESH_MS  30000U  /* Maximum time with RDS interrupt disabled */
+
+/**
+ * @brief Init gating, RDS interrupt enabled
+ */
+void fm_rdsGate_init(void);
+
+/**
+ * @brief Call it after each seek or tune, and when AF switch tunes another
+ * frequency. RDS interrupt is enabled again until PS and RT of new station
+ * are confirmed.
+ */
+void fm_rdsGate_newStation(void);
+
+/**
+ * @brief Call it each time RDS service decoded groups, interrupt or polled.
+ *
+ * @param rtGroup     [in] true if an RT group was decoded
+ * @param abFlag      [in] text A/B flag of last RT group
+ * @param psComplete  [in] true if PS name is complete
+ * @param rtComplete  [in] true if an RT message was completed
+ */
+void fm_rdsGate_group(bool rtGroup, uint8_t abFlag, bool psComplete, bool rtComplete);
+
+/**
+ * @brief Call it periodically while RDS is decoded. While gated, polls one
+ * group from time to time.
+ *
+ * @param group   [out] RDS group polled
+ * @return true   if a group was polled, it must be decoded
+ * @return false  if nothing to decode
+ */
+bool fm_rdsGate_process(rds_groupBlocks *group);
+
+/**
+ * @brief Check if RDS interrupt is disabled by gating
+ *
+ * @return true if gated
+ */
+bool fm_rdsGate_isGated(void);
+
+#endif /* _SI470X_RDSGATE_H_ */
@@ -0,0 +1,189 @@
+/**
+ * @file    si470x_rdsRing.c
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   RDS groups captured by GPIO2 interrupt. See si470x_rdsRing.h
+ * @version 0.1
+ * @date    2023-09-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "si470x_rdsRing.h"
+#include "si470x_comm.h"
+#include "si470x_driver.h"
+
+#define FM_RDSRING_MASK   (FM_RDSRING_SIZE - 1U)
+
+static fm_rdsRing_entry  _ring[FM_RDSRING_SIZE];
+static volatile uint8_t  _head;        /* Next free entry, written by producer only. Free running */
+static volatile uint8_t  _tail;        /* Oldest entry, written by consumer only. Free running */
+static volatile bool     _enabled;
+static volatile bool     _capturing;   /* A capture is on going, in main loop or interrupt */
+static volatile bool     _deferred;    /* Interrupt found I2C busy, main loop captures instead */
+static volatile uint8_t  _station;     /* Incremented at each new station, by core0 only */
+static fm_rdsRing_stats  _stats;
+
+/**
+ * @brief Read a group from Si470x and push it. Only one capture at a time,
+ * so that there is only one producer.
+ */
+static void fm_rdsRing_capture(void);
+
+/**
+ * @brief Write a group in ring, by the only producer at that time
+ */
+static bool fm_rdsRing_write(const rds_groupBlocks *group, uint8_t rssi);
+
+void fm_rdsRing_init(void)
+{
+   _enabled   = false;
+   _capturing = false;
+   _deferred  = false;
+   _head      = 0x00;
+   _tail      = 0x00;
+   _station   = 0x00;
+   _stats._captured  = 0x00;
+   _stats._overflows = 0x00;
+   _stats._deferred  = 0x00;
+   _stats._notReady  = 0x00;
+   _stats._maxFill   = 0x00;
+}
+
+void fm_rdsRing_enable(bool enable)
+{
+   _enabled = enable;
+   if(false == enable)
+   {
+      _deferred = false;
+   }
+}
+
+void fm_rdsRing_irq(void)
+{
+   if(true == _enabled)
+   {
+      /* Never interleave an I2C transfer with the one of main loop */
+      if((true == _capturing) || (true == si470x_comm_isBusy()))
+      {
+         _deferred = true;
+         _stats._deferred++;
+      }
+      else
+      {
+         fm_rdsRing_capture();
+      }
+   }
+}
+
+void fm_rdsRing_process(void)
+{
+   /* Group is kept by Si470x until next one, ~88 ms: still there */
+   if((true == _enabled) && (true == _deferred))
+   {
+      /* Capture marked on going first: an interrupt in between defers
+       * again instead of reading the same group itself */
+      _capturing = true;
+      _deferred  = false;
+      fm_rdsRing_capture();
+   }
+}
+
+bool fm_rdsRing_push(const rds_groupBlocks *group)
+{
+   uint32_t interrupts;
+   bool     retVal = false;
+
+   /* GPIO2 interrupt is the other producer: not while this one writes */
+   interrupts = save_and_disable_interrupts();
+   retVal = fm_rdsRing_write(group, 0x00);
+   restore_interrupts(interrupts);
+
+   return retVal;
+}
+
+bool fm_rdsRing_pop(fm_rdsRing_entry *entry)
+{
+   bool retVal = false;
+
+   if(_head != _tail)
+   {
+      *entry = _ring[_tail & FM_RDSRING_MASK];
+      /* Entry copied before it is given back to producer */
+      __dmb();
+      _tail  = (uint8_t)(_tail + 1U);
+      retVal = true;
+   }
+   return retVal;
+}
+
+void fm_rdsRing_newStation(void)
+{
+   _station = (uint8_t)(_station + 1U);
+   __dmb();
+   /* Consumer resets its decoder even if no group comes */
+   __sev();
+}
+
+uint8_t fm_rdsRing_getStation(void)
+{
+   return _station;
+}
+
+void fm_rdsRing_getStats(fm_rdsRing_stats *stats)
+{
+   *stats = _stats;
+}
+
+static void fm_rdsRing_capture(void)
+{
+   rds_groupBlocks group;
+   uint8_t         rssi = 0x00;
+
+   _capturing = true;
+   if(true == si470x_readBlocks(&group, &rssi))
+   {
+      fm_rdsRing_write(&group, rssi);
+   }
+   else
+   {
+      _stats._notReady++;
+   }
+   _capturing = false;
+}
+
+static bool fm_rdsRing_write(const rds_groupBlocks *group, uint8_t rssi)
+{
+   uint8_t head = _head;
+   uint8_t fill = (uint8_t)(head - _tail);
+   fm_rdsRing_entry *entry = &_ring[head & FM_RDSRING_MASK];
+   bool    retVal = false;
+
+   if(FM_RDSRING_SIZE <= fill)
+   {
+      /* Consumer is late: keep what it will read next, drop newest */
+      _stats._overflows++;
+   }
+   else
+   {
+      entry->_group   = *group;
+      entry->_timeMs  = to_ms_since_boot(get_absolute_time());
+      entry->_station = _station;
+      entry->_rssi    = rssi;
+      /* Entry written before it is given to consumer */
+      __dmb();
+      _head = (uint8_t)(head + 1U);
+      /* Wake up consumer, it waits for events */
+      __sev();
+      _stats._captured++;
+      fill++;
+      if(fill > _stats._maxFill)
+      {
+         _stats._maxFill = fill;
+      }
+      retVal = true;
+   }
+   return retVal;
+}
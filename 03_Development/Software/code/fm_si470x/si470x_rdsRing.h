@@ -0,0 +1,122 @@
+/**
+ * @file    si470x_rdsRing.h
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   RDS groups captured by GPIO2 interrupt. Si470x keeps only the last
+ *          group (~88 ms each): a main loop blocked by an e-paper refresh
+ *          lost groups, and several GPIO2 edges were coalesced in one token.
+ *          Now each GPIO2 interrupt reads its group and pushes it in a
+ *          single-producer/single-consumer ring, RDS service drains it.
+ *             - producer: GPIO2 interrupt, it only writes _head. Groups polled
+ *               by main loop are pushed with interrupts disabled
+ *             - consumer: RDS service on core1, it only writes _tail
+ *          Each group is stamped with the station it was captured on, stale
+ *          ones are dropped by consumer: core0 never empties the ring itself.
+ *          If an I2C transfer of main loop is on going, interrupt does not
+ *          touch the bus: capture is deferred to next fm_rdsRing_process().
+ *          A full ring drops the newest group, and counts it.
+ * @version 0.1
+ * @date    2023-09-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _SI470X_RDSRING_H_
+#define _SI470X_RDSRING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rdsDecoder.h"
+
+#define FM_RDSRING_SIZE   32U   /* Power of 2, up to 128. ~2.8 s of groups */
+
+/**
+ * @brief One captured group
+ */
+typedef struct {
+   rds_groupBlocks _group;
+   uint32_t        _timeMs;     /* Time of capture, since boot */
+   uint8_t         _station;    /* Station counter at capture, see fm_rdsRing_newStation() */
+   uint8_t         _rssi;       /* RSSI read with group, 0 if polled by main loop */
+} fm_rdsRing_entry;
+
+/**
+ * @brief Capture counters, since fm_rdsRing_init()
+ */
+typedef struct {
+   uint32_t _captured;     /* Groups pushed in ring */
+   uint32_t _overflows;    /* Groups dropped, ring was full */
+   uint32_t _deferred;     /* Interrupts which found I2C busy */
+   uint32_t _notReady;     /* Interrupts without RDSR: STC, or group already read */
+   uint8_t  _maxFill;      /* Highest qty of groups waiting in ring */
+} fm_rdsRing_stats;
+
+/**
+ * @brief Init ring, empty and capture disabled. Counters are reset.
+ */
+void fm_rdsRing_init(void);
+
+/**
+ * @brief Enable or disable capture by GPIO2 interrupt. Enable it only while
+ * GPIO2 means RDS, not STC of a seek or tune. Disabling drops a deferred
+ * capture: only do it when leaving actual station (seek, tune, AF check).
+ *
+ * @param enable [in] true to capture groups
+ */
+void fm_rdsRing_enable(bool enable);
+
+/**
+ * @brief Call it from GPIO2 interrupt. Group is read right there, so that a
+ * blocked main loop loses nothing: RDSA..RDSD read is 13 bytes at
+ * SI470X_COMM_BAUDRATE (400 kHz), ~0.3 ms. GPIO bank interrupt (rotary
+ * encoders, RN52 GPIO2) waits that long at worst, RN52 UART FIFO holds
+ * ~2.8 ms of characters at 115200 bauds: nothing is lost.
+ */
+void fm_rdsRing_irq(void);
+
+/**
+ * @brief Call it from main loop, before draining ring. Captures a group
+ * deferred by interrupt.
+ */
+void fm_rdsRing_process(void);
+
+/**
+ * @brief Push a group polled by main loop (gating, preset check). Works even
+ * if capture by interrupt is disabled.
+ *
+ * @param group   [in] group polled
+ * @return true   if pushed
+ * @return false  if ring is full
+ */
+bool fm_rdsRing_push(const rds_groupBlocks *group);
+
+/**
+ * @brief Get oldest group of ring. Consumer only.
+ *
+ * @param entry   [out] oldest group and its time of capture
+ * @return true   if a group was waiting
+ * @return false  if ring is empty
+ */
+bool fm_rdsRing_pop(fm_rdsRing_entry *entry);
+
+/**
+ * @brief Call it after a seek or tune: groups captured before are stale.
+ * Core0 only.
+ */
+void fm_rdsRing_newStation(void);
+
+/**
+ * @brief Get station counter, groups stamped with another one are stale
+ *
+ * @return uint8_t station counter
+ */
+uint8_t fm_rdsRing_getStation(void);
+
+/**
+ * @brief Get capture counters
+ *
+ * @param stats [out] counters
+ */
+void fm_rdsRing_getStats(fm_rdsRing_stats *stats);
+
+#endif /* _SI470X_RDSRING_H_ */
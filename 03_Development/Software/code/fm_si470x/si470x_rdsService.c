@@ -0,0 +1,306 @@
+/**
+ * @file    si470x_rdsService.c
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   RDS decoding service on core1. See si470x_rdsService.h
+ * @version 0.1
+ * @date    2023-09-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+#include "si470x_rdsService.h"
+#include "si470x_rdsRing.h"
+#include "si470x_driver.h"
+#if defined(FM_RDS_RECORDER)
+#include "rdsCapture.h"
+#endif
+
+static fm_rdsSnapshot    _published;   /* Copied by core0 */
+static volatile uint32_t _sequence;    /* Odd while core1 writes _published */
+static fm_rdsSnapshot    _work;        /* Core1 only */
+static fm_rdsStats       _publishedStats;   /* Published with _published */
+static fm_rdsStats       _workStats;        /* Core1 only */
+#if defined(FM_RDS_STATS)
+static uint32_t          _statsDumpMs;      /* Last dump, core0 */
+#endif
+static rds_decoder       _decoder;     /* Core1 only, once started */
+#if defined(FM_RDS_RECORDER)
+static bool              _recordNewStation;  /* Next group recorded is the first one of a station */
+#endif
+
+/**
+ * @brief Entry point of core1, never returns
+ */
+static void fm_rdsService_core1Main(void);
+
+/**
+ * @brief Reset decoder and working snapshot for a new station. Core1 only.
+ */
+static void fm_rdsService_reset(uint8_t station);
+
+/**
+ * @brief Decode one group into working snapshot and statistics. Core1 only.
+ */
+static void fm_rdsService_decode(const rds_groupBlocks *group, uint32_t timeMs);
+
+/**
+ * @brief Copy working snapshot for core0. Core1 only.
+ */
+static void fm_rdsService_publish(void);
+
+#if defined(FM_RDS_RECORDER)
+/**
+ * @brief Stream a group over UART as a capture line, see rdsCapture.h
+ */
+static void fm_rdsService_record(const fm_rdsRing_entry *entry);
+#endif
+
+void fm_rdsService_init(RT_QUALITY_STATE rtQuality)
+{
+   rdsDecoder_init_r(&_decoder, rtQuality, false);
+   memset(&_work, 0, sizeof(_work));
+   memset(&_work._psName[0], 0x20, PS_GROUP_MAX_CHARS);
+   _work._station = fm_rdsRing_getStation();
+   _published     = _work;
+   memset(&_workStats, 0, sizeof(_workStats));
+   _publishedStats = _workStats;
+#if defined(FM_RDS_STATS)
+   _statsDumpMs   = to_ms_since_boot(get_absolute_time());
+#endif
+   _sequence      = 0x00;
+#if defined(FM_RDS_RECORDER)
+   _recordNewStation = true;
+#endif
+
+   multicore_launch_core1(&fm_rdsService_core1Main);
+}
+
+void fm_rdsService_newStation(void)
+{
+   fm_rdsRing_newStation();
+}
+
+bool fm_rdsService_getSnapshot(fm_rdsSnapshot *snapshot)
+{
+   uint32_t sequence = 0x00;
+
+   /* Copy again if core1 published meanwhile */
+   do
+   {
+      sequence = _sequence;
+      __dmb();
+      *snapshot = _published;
+      __dmb();
+   } while((0x00 != (sequence & 0x01)) || (sequence != _sequence));
+
+   return (snapshot->_station == fm_rdsRing_getStation());
+}
+
+bool fm_rdsService_getStats(fm_rdsStats *stats)
+{
+   uint32_t sequence = 0x00;
+   uint8_t  station  = 0x00;
+
+   /* Same sequence as snapshot */
+   do
+   {
+      sequence = _sequence;
+      __dmb();
+      *stats   = _publishedStats;
+      station  = _published._station;
+      __dmb();
+   } while((0x00 != (sequence & 0x01)) || (sequence != _sequence));
+
+   return (station == fm_rdsRing_getStation());
+}
+
+void fm_rdsService_dumpStats(void)
+{
+   fm_rdsStats       stats;
+   fm_rdsRing_stats  ringStats;
+   si470x_rdsStats_t readStats;
+   uint32_t nowMs = to_ms_since_boot(get_absolute_time());
+   uint8_t  code  = 0x00;
+   uint8_t  block = 0x00;
+
+   (void)fm_rdsService_getStats(&stats);
+   fm_rdsRing_getStats(&ringStats);
+   si470x_getRdsStats(&readStats);
+
+   printf("[FM][RDS] Stats: %lu groups, %lu discarded (block B), %lu unhandled, %lu TP\n",
+          (unsigned long)stats._decoder._groups, (unsigned long)stats._decoder._discarded,
+          (unsigned long)stats._decoder._unhandled, (unsigned long)stats._decoder._tpGroups);
+   printf("[FM][RDS] Groups:");
+   for(code = 0; code < RDS_GROUP_CODES; code++)
+   {
+      if(0 < stats._decoder._groupCodes[code])
+      {
+         printf(" %u%c:%lu", code >> 1, (0x00 == (code & 0x01)) ? 'A' : 'B', (unsigned long)stats._decoder._groupCodes[code]);
+      }
+   }
+   printf("\n");
+   for(block = 0; block < RDS_BLOCKS; block++)
+   {
+      printf("[FM][RDS] BLER %c: none %lu, 1-2 %lu, 3-5 %lu, uncorrectable %lu\n", 'A' + block,
+             (unsigned long)stats._decoder._bler[block][RDS_BLER_NONE], (unsigned long)stats._decoder._bler[block][RDS_BLER_1_2],
+             (unsigned long)stats._decoder._bler[block][RDS_BLER_3_5], (unsigned long)stats._decoder._bler[block][RDS_BLER_UNCORRECTABLE]);
+   }
+   printf("[FM][RDS] Last group %ld ms ago, PS %ld ms ago, RT %ld ms ago (-1: never)\n",
+          (0 < stats._decoder._groups)  ? (long)(nowMs - stats._lastGroupMs) : -1L,
+          (0 < stats._decoder._lastPSGroup) ? (long)(nowMs - stats._lastPSMs) : -1L,
+          (0 < stats._decoder._lastRTGroup) ? (long)(nowMs - stats._lastRTMs) : -1L);
+   printf("[FM][RDS] Ring: %lu captured, %lu overflows, %lu deferred, %lu not ready, max fill %u\n",
+          (unsigned long)ringStats._captured, (unsigned long)ringStats._overflows, (unsigned long)ringStats._deferred,
+          (unsigned long)ringStats._notReady, ringStats._maxFill);
+   printf("[FM][RDS] Si470x: %lu reads, %lu RDSR not ready, %lu I2C errors\n",
+          (unsigned long)readStats._reads, (unsigned long)readStats._notReady, (unsigned long)readStats._errors);
+}
+
+void fm_rdsService_statsProcess(void)
+{
+#if defined(FM_RDS_STATS)
+   uint32_t nowMs = to_ms_since_boot(get_absolute_time());
+
+   if((nowMs - _statsDumpMs) >= FM_RDS_STATS_PERIOD_MS)
+   {
+      _statsDumpMs = nowMs;
+      fm_rdsService_dumpStats();
+   }
+#endif
+}
+
+static void fm_rdsService_core1Main(void)
+{
+   fm_rdsRing_entry entry;
+   uint8_t station = 0x00;
+
+   /* nv_flash stops this core while it erases or programs flash */
+   multicore_lockout_victim_init();
+
+   while(true)
+   {
+      station = fm_rdsRing_getStation();
+      if(station != _work._station)
+      {
+         fm_rdsService_reset(station);
+         fm_rdsService_publish();
+      }
+
+      if(true == fm_rdsRing_pop(&entry))
+      {
+         /* Station changed since counter was read above */
+         if((entry._station != _work._station) && (entry._station == fm_rdsRing_getStation()))
+         {
+            fm_rdsService_reset(entry._station);
+         }
+         /* Else, captured on a previous station: dropped */
+         if(entry._station == _work._station)
+         {
+#if defined(FM_RDS_RECORDER)
+            fm_rdsService_record(&entry);
+#endif
+            fm_rdsService_decode(&entry._group, entry._timeMs);
+            fm_rdsService_publish();
+         }
+      }
+      else
+      {
+         /* Woken up by ring (SEV) */
+         __wfe();
+      }
+   }
+}
+
+static void fm_rdsService_reset(uint8_t station)
+{
+   rdsDecoder_resetStation_r(&_decoder);
+   memset(&_work, 0, sizeof(_work));
+   memset(&_workStats, 0, sizeof(_workStats));
+   _work._station = station;
+   rdsDecoder_getPS_r(&_decoder, &_work._psName[0]);
+#if defined(FM_RDS_RECORDER)
+   _recordNewStation = true;
+#endif
+}
+
+static void fm_rdsService_decode(const rds_groupBlocks *group, uint32_t timeMs)
+{
+   uint8_t rtMsg[RT_GROUP_MAX_CHARS];
+   uint8_t sizeOfRTmsg = 0x00;
+
+   _work._groups++;
+   sizeOfRTmsg = rdsDecoder_processNewGroup_r(&_decoder, &rtMsg[0], group);
+
+   /* Text A/B flag, for RDS gating of core0 */
+   if((RDS_BLER_UNCORRECTABLE != group->bler_B)
+   && (GROUP_TYPE_RT == ((group->block_B & BLOCKB_GROUP_TYPE_MASK) >> BLOCKB_GROUP_TYPE_POS)))
+   {
+      _work._rtAbFlag = (uint8_t)((group->block_B & BLOCKB_RT_AB_FLAG_MASK) >> BLOCKB_RT_AB_FLAG_POS);
+      _work._rtGroups++;
+   }
+
+   if(0 < sizeOfRTmsg)
+   {
+      memcpy(&_work._rt[0], &rtMsg[0], sizeOfRTmsg);
+      _work._rtSize = sizeOfRTmsg;
+      _work._rtCompletes++;
+      _workStats._lastRTMs = timeMs;
+   }
+   else
+   {
+      sizeOfRTmsg = rdsDecoder_getRTPrefix_r(&_decoder, &rtMsg[0]);
+      if(0 < sizeOfRTmsg)
+      {
+         memcpy(&_work._rtPrefix[0], &rtMsg[0], sizeOfRTmsg);
+         _work._rtPrefixSize = sizeOfRTmsg;
+         _work._rtPrefixes++;
+      }
+   }
+
+   _work._pi         = rdsDecoder_getPI_r(&_decoder);
+   _work._pty        = rdsDecoder_getPTY_r(&_decoder);
+   _work._psComplete = rdsDecoder_getPS_r(&_decoder, &_work._psName[0]);
+   _work._psDynamic  = rdsDecoder_isPSDynamic_r(&_decoder);
+   if(true == rdsDecoder_getPSEvent_r(&_decoder))
+   {
+      _work._psEvents++;
+      _workStats._lastPSMs = timeMs;
+   }
+   _work._afCount    = rdsDecoder_getAF_r(&_decoder, &_work._afList[0]);
+
+   _workStats._lastGroupMs = timeMs;
+   rdsDecoder_getStats_r(&_decoder, &_workStats._decoder);
+}
+
+static void fm_rdsService_publish(void)
+{
+   _sequence++;
+   __dmb();
+   _published      = _work;
+   _publishedStats = _workStats;
+   __dmb();
+   _sequence++;
+}
+
+#if defined(FM_RDS_RECORDER)
+static void fm_rdsService_record(const fm_rdsRing_entry *entry)
+{
+   rds_captureRecord record;
+   char line[RDS_CAPTURE_LINE_SIZE];
+
+   record._timeMs = entry->_timeMs;
+   record._group  = entry->_group;
+   record._rssi   = entry->_rssi;
+   record._flags  = (true == _recordNewStation) ? RDS_CAPTURE_FLAG_NEW_STATION : 0x00;
+   _recordNewStation = false;
+
+   rdsCapture_toLine(&line[0], &record);
+   printf("%s", line);
+}
+#endif
@@ -0,0 +1,111 @@
+/**
+ * @file    si470x_rdsService.h
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   RDS decoding service on core1. Core0 keeps I2C, e-paper, encoders
+ *          and Bluetooth; core1 owns an rdsDecoder instance:
+ *             - it drains RDS ring (si470x_rdsRing.h), filled by GPIO2
+ *               interrupt and by groups polled on core0
+ *             - it decodes each group and publishes what it found in a
+ *               snapshot: PS name, RT message, AF list...
+ *             - it sleeps (WFE) while ring is empty
+ *          Snapshot is published with a sequence counter (odd while core1
+ *          writes it), core0 copies it again if it changed meanwhile: no lock,
+ *          and multicore FIFO stays free for flash lockout (nv_flash).
+ *          Events (PS changed, RT complete...) are counters, core0 compares
+ *          them with the ones of its previous copy: none is lost if core0 is
+ *          late, several ones are only merged.
+ *          Decoder instance is private to the service: default instance of
+ *          rdsDecoder is not used by the radio.
+ * @version 0.1
+ * @date    2023-09-21
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _SI470X_RDSSERVICE_H_
+#define _SI470X_RDSSERVICE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rdsDecoder.h"
+
+/**
+ * @brief What core1 decoded for actual station
+ */
+typedef struct {
+   uint8_t  _station;                         /* Station counter these data belong to, see fm_rdsRing_newStation() */
+   uint32_t _groups;                          /* Groups decoded for this station */
+   uint16_t _pi;                              /* 0x0000 if not known yet */
+   uint8_t  _pty;
+   uint8_t  _psName[PS_GROUP_MAX_CHARS];      /* Last stable PS name, spaces if none yet */
+   bool     _psComplete;
+   bool     _psDynamic;                       /* Scrolling text, not a station name */
+   uint32_t _psEvents;                        /* Incremented at each new stable PS name */
+   uint8_t  _rt[RT_GROUP_MAX_CHARS];          /* Last complete RT message */
+   uint8_t  _rtSize;
+   uint32_t _rtCompletes;                     /* Incremented at each complete RT message */
+   uint8_t  _rtPrefix[RT_GROUP_MAX_CHARS];    /* Beginning of RT being received */
+   uint8_t  _rtPrefixSize;
+   uint32_t _rtPrefixes;                      /* Incremented at each longer beginning */
+   uint8_t  _rtAbFlag;                        /* Text A/B flag of last RT group */
+   uint32_t _rtGroups;                        /* RT groups decoded */
+   uint8_t  _afList[AF_MAX_FREQS];
+   uint8_t  _afCount;
+} fm_rdsSnapshot;
+
+/**
+ * @brief Reception statistics of actual station, published with snapshot
+ */
+typedef struct {
+   rds_stats _decoder;                        /* Counters of decoder, see rds_stats */
+   uint32_t  _lastGroupMs;                    /* Capture time of last group decoded */
+   uint32_t  _lastPSMs;                       /* Capture time of last new stable PS name, 0 if none */
+   uint32_t  _lastRTMs;                       /* Capture time of last complete RT message, 0 if none */
+} fm_rdsStats;
+
+#define FM_RDS_STATS_PERIOD_MS  10000U   /* Debug dump period, if built with FM_RDS_STATS */
+
+/**
+ * @brief Init decoder instance of service and start service on core1
+ *
+ * @param rtQuality [in] RT quality level of decoder, see rdsDecoder_init()
+ */
+void fm_rdsService_init(RT_QUALITY_STATE rtQuality);
+
+/**
+ * @brief Call it after a seek or tune: core1 resets its decoder, groups of
+ * previous station still in ring are dropped.
+ */
+void fm_rdsService_newStation(void);
+
+/**
+ * @brief Get a consistent copy of last snapshot published by core1
+ *
+ * @param snapshot [out] copy of snapshot
+ * @return true    if it belongs to actual station
+ * @return false   if core1 did not handle last fm_rdsService_newStation() yet
+ */
+bool fm_rdsService_getSnapshot(fm_rdsSnapshot *snapshot);
+
+/**
+ * @brief Get a consistent copy of reception statistics published by core1
+ *
+ * @param stats    [out] copy of statistics
+ * @return true    if they belong to actual station
+ */
+bool fm_rdsService_getStats(fm_rdsStats *stats);
+
+/**
+ * @brief Print reception statistics of actual station, with counters of RDS
+ * ring and Si470x reads
+ */
+void fm_rdsService_dumpStats(void);
+
+/**
+ * @brief Call it from main loop while RDS is decoded: statistics are dumped
+ * every FM_RDS_STATS_PERIOD_MS if built with FM_RDS_STATS, nothing otherwise
+ */
+void fm_rdsService_statsProcess(void);
+
+#endif /* _SI470X_RDSSERVICE_H_ */
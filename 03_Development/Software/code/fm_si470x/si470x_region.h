@@ -0,0 +1,79 @@
+/**
+ * @file    si470x_region.h
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   FM region of radio, chosen at compile time. A radio is sold (and
+ *          used) in one region, there is no need to carry all of them and
+ *          to look them up at each frequency conversion.
+ *          Select it with CMake: -DFM_REGION=EUROPE (default), USA, JAPAN,
+ *          JAPAN_WIDE or ITALY. It defines SI470X_REGION_<region>.
+ *
+ *          Frequencies are in kHz, so that frequency/channel conversions are
+ *          integer operations on constants:
+ *             freq = SI470X_BAND_BOTTOM_KHZ + channel * SI470X_SPACING_KHZ
+ *          See Si4702/03 datasheet, register 03h (CHANNEL).
+ * @version 0.1
+ * @date    2023-09-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _SI470X_REGION_H_
+#define _SI470X_REGION_H_
+
+#include "si470x_driver_regs.h"
+
+#if defined(SI470X_REGION_USA)
+   /* Americas, South Korea, Australia */
+   #define SI470X_BAND              FM_BAND_USAEUROPE
+   #define SI470X_BAND_BOTTOM_KHZ   87500U
+   #define SI470X_BAND_TOP_KHZ      108000U
+   #define SI470X_SPACING           FM_CHANNEL_SPACING_200
+   #define SI470X_SPACING_KHZ       200U
+   #define SI470X_DEEMPHASIS        FM_DEEMPHASIS_75
+#elif defined(SI470X_REGION_JAPAN)
+   #define SI470X_BAND              FM_BAND_JAPAN
+   #define SI470X_BAND_BOTTOM_KHZ   76000U
+   #define SI470X_BAND_TOP_KHZ      90000U
+   #define SI470X_SPACING           FM_CHANNEL_SPACING_100
+   #define SI470X_SPACING_KHZ       100U
+   #define SI470X_DEEMPHASIS        FM_DEEMPHASIS_50
+#elif defined(SI470X_REGION_JAPAN_WIDE)
+   #define SI470X_BAND              FM_BAND_JAPAN_WIDE
+   #define SI470X_BAND_BOTTOM_KHZ   76000U
+   #define SI470X_BAND_TOP_KHZ      108000U
+   #define SI470X_SPACING           FM_CHANNEL_SPACING_100
+   #define SI470X_SPACING_KHZ       100U
+   #define SI470X_DEEMPHASIS        FM_DEEMPHASIS_50
+#elif defined(SI470X_REGION_ITALY)
+   #define SI470X_BAND              FM_BAND_USAEUROPE
+   #define SI470X_BAND_BOTTOM_KHZ   87500U
+   #define SI470X_BAND_TOP_KHZ      108000U
+   #define SI470X_SPACING           FM_CHANNEL_SPACING_50
+   #define SI470X_SPACING_KHZ       50U
+   #define SI470X_DEEMPHASIS        FM_DEEMPHASIS_50
+#else
+   /* SI470X_REGION_EUROPE, default */
+   #define SI470X_BAND              FM_BAND_USAEUROPE
+   #define SI470X_BAND_BOTTOM_KHZ   87500U
+   #define SI470X_BAND_TOP_KHZ      108000U
+   #define SI470X_SPACING           FM_CHANNEL_SPACING_100
+   #define SI470X_SPACING_KHZ       100U
+   #define SI470X_DEEMPHASIS        FM_DEEMPHASIS_50
+#endif
+
+/* Seek profile used at power up, adaptive controller (si470x_seekSens) moves from it */
+#ifndef SI470X_SEEK_PROFILE
+   #define SI470X_SEEK_PROFILE      FM_SEEK_SENSITIVITY_RECOMMENDED
+#endif
+
+#define SI470X_CHANNEL_MAX          ((SI470X_BAND_TOP_KHZ - SI470X_BAND_BOTTOM_KHZ) / SI470X_SPACING_KHZ)
+
+/* Frequency in MHz (float API) to kHz, rounded */
+#define SI470X_MHZ_TO_KHZ(mhz)      ((uint32_t)(((mhz) * 1000.0f) + 0.5f))
+/* Channel of a frequency in kHz, rounded to nearest channel. Frequency must be in band */
+#define SI470X_KHZ_TO_CHANNEL(khz)  ((uint16_t)(((khz) - SI470X_BAND_BOTTOM_KHZ + (SI470X_SPACING_KHZ / 2U)) / SI470X_SPACING_KHZ))
+/* Frequency in kHz of a channel */
+#define SI470X_CHANNEL_TO_KHZ(chan) (SI470X_BAND_BOTTOM_KHZ + ((uint32_t)(chan) * SI470X_SPACING_KHZ))
+
+#endif /* _SI470X_REGION_H_ */
@@ -0,0 +1,156 @@
+/**
+ * @file    si470x_seekSens.c
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Adaptive seek sensitivity controller. See si470x_seekSens.h
+ *
+ *          Presets are sorted from the one which finds the fewest stations to
+ *          the one which finds the most (AN230, Seek Settings Recommendations):
+ *             GOOD_QUALITY -> RECOMMENDED -> MORE -> MOST
+ *          FM_SEEK_SENSITIVITY_DEFAULT (firmware 14 compatible) is not part of
+ *          the ladder, it is considered to be at RECOMMENDED step.
+ *
+ *          - SF/BL set: full band was scanned for nothing, go one step more sensitive
+ *          - Weak RSSI found several times in a row: noise stops, go one step less sensitive
+ *          - Good RSSI found: credit preset. Quick locks are credited more than
+ *            slow ones which went over most of the band.
+ * @version 0.1
+ * @date    2023-09-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "si470x_seekSens.h"
+
+#define FM_SEEKSENS_LADDER_SIZE 4U
+
+static const FM_SEEK_SENSITIVITY seekSensLadder[FM_SEEKSENS_LADDER_SIZE] =
+{FM_SEEK_SENSITIVITY_GOOD_QUALITY,
+ FM_SEEK_SENSITIVITY_RECOMMENDED,
+ FM_SEEK_SENSITIVITY_MORE,
+ FM_SEEK_SENSITIVITY_MOST
+};
+
+static FM_SEEK_SENSITIVITY _current;                         /* Preset used for next seek */
+static uint8_t             _score[FM_SEEK_SENSITIVITY_MAX];  /* Good seeks found with each preset */
+static uint8_t             _weakStreak;                      /* Weak stations found in a row */
+static uint32_t            _seekStartMs;                     /* Time at which last seek started */
+
+/**
+ * @brief Get step of a preset in seekSensLadder
+ */
+static uint8_t fm_seekSens_getLadderStep(FM_SEEK_SENSITIVITY preset);
+
+/**
+ * @brief Get preset with best score
+ */
+static FM_SEEK_SENSITIVITY fm_seekSens_getBest(void);
+
+void fm_seekSens_init(void)
+{
+   _current     = si470x_getSeekSensitivity();
+   _weakStreak  = 0x00;
+   _seekStartMs = 0x00;
+   memset(&_score[0], 0, sizeof(_score));
+}
+
+void fm_seekSens_import(const uint8_t *ptrScores)
+{
+   uint8_t index = 0x00;
+
+   for(index = 0; index < FM_SEEK_SENSITIVITY_MAX; index++)
+   {
+      _score[index] = MIN(ptrScores[index], FM_SEEKSENS_SCORE_MAX);
+   }
+   _current = fm_seekSens_getBest();
+   printf("[FM][SENS] Scores restored, start preset: %d\n", _current);
+}
+
+void fm_seekSens_export(uint8_t *ptrScores)
+{
+   memcpy(ptrScores, &_score[0], sizeof(_score));
+}
+
+void fm_seekSens_prepareSeek(void)
+{
+   /* Does nothing if preset already active */
+   si470x_setSeekSensitivity(_current);
+   _seekStartMs = to_ms_since_boot(get_absolute_time());
+}
+
+bool fm_seekSens_seekFinished(uint8_t rssi)
+{
+   bool retVal = false;
+   uint32_t lockTimeMs = to_ms_since_boot(get_absolute_time()) - _seekStartMs;
+   uint8_t  step       = fm_seekSens_getLadderStep(_current);
+
+   if(0x00 == rssi)
+   {
+      /* SF/BL - nothing found on the whole band, same preset would do it again */
+      _weakStreak = 0x00;
+      if(0 < _score[_current])
+      {
+         _score[_current]--;
+      }
+
+      if((FM_SEEKSENS_LADDER_SIZE - 1) > step)
+      {
+         _current = seekSensLadder[step + 1];
+         retVal = true;
+      }
+   }
+   else if(FM_SEEKSENS_WEAK_RSSI > rssi)
+   {
+      /* Found something, but it is most probably noise */
+      _weakStreak++;
+      if((FM_SEEKSENS_WEAK_STREAK <= _weakStreak) && (0 < step))
+      {
+         _current    = seekSensLadder[step - 1];
+         _weakStreak = 0x00;
+      }
+   }
+   else
+   {
+      _weakStreak = 0x00;
+      /* Quick lock: preset stopped at the first good station. Credit it more */
+      _score[_current] += (FM_SEEKSENS_SLOW_LOCK_MS > lockTimeMs) ? 2U : 1U;
+      _score[_current]  = MIN(_score[_current], FM_SEEKSENS_SCORE_MAX);
+   }
+
+   printf("[FM][SENS] Seek RSSI: %d, lock: %lu ms, next preset: %d\n", rssi, (unsigned long)lockTimeMs, _current);
+   return retVal;
+}
+
+static FM_SEEK_SENSITIVITY fm_seekSens_getBest(void)
+{
+   /* In case of equality (or nothing learned yet), keep preset in use */
+   FM_SEEK_SENSITIVITY bestPreset = _current;
+   uint8_t index = 0x00;
+
+   for(index = 0; index < FM_SEEK_SENSITIVITY_MAX; index++)
+   {
+      if(_score[index] > _score[bestPreset])
+      {
+         bestPreset = (FM_SEEK_SENSITIVITY)index;
+      }
+   }
+   return bestPreset;
+}
+
+static uint8_t fm_seekSens_getLadderStep(FM_SEEK_SENSITIVITY preset)
+{
+   uint8_t step = 0x01; /* FM_SEEK_SENSITIVITY_DEFAULT is at RECOMMENDED step */
+   uint8_t index = 0x00;
+
+   for(index = 0; index < FM_SEEKSENS_LADDER_SIZE; index++)
+   {
+      if(seekSensLadder[index] == preset)
+      {
+         step = index;
+      }
+   }
+   return step;
+}
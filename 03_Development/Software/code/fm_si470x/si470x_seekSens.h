@@ -0,0 +1,67 @@
+/**
+ * @file    si470x_seekSens.h
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Adaptive seek sensitivity controller. It watches the result of each
+ *          seek (SF/BL failure, RSSI of found station, time to lock) and moves
+ *          between the FM_SEEK_SENSITIVITY_* presets of AN230, so that a seek
+ *          finds a station with as few full band cycles as possible.
+ *          Band region is fixed at compile time (FM_REGION), so one score
+ *          table is enough. It is saved in flash by application, next boot
+ *          starts from the best preset learned so far.
+ * @version 0.1
+ * @date    2023-09-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _SI470X_SEEKSENS_H_
+#define _SI470X_SEEKSENS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "si470x_driver.h"
+
+#define FM_SEEKSENS_WEAK_RSSI       20U   /* dBµV, found station under it is most probably noise */
+#define FM_SEEKSENS_WEAK_STREAK     2U    /* Weak stations found in a row before going less sensitive */
+#define FM_SEEKSENS_SLOW_LOCK_MS    4000U /* A seek longer than that went over most of the band */
+#define FM_SEEKSENS_SCORE_MAX       15U   /* Saturation of success score of a preset */
+
+/**
+ * @brief Init controller. It starts with the preset configured in Si470x
+ *        driver (see si470x_init()) until saved scores are imported.
+ */
+void fm_seekSens_init(void);
+
+/**
+ * @brief Call it right before si470x_startSeek(). It writes the chosen preset
+ *        and starts time to lock measurement.
+ */
+void fm_seekSens_prepareSeek(void);
+
+/**
+ * @brief Call it when seek is finished (STC). Updates preset scores and moves
+ *        to a more or less sensitive preset if needed.
+ *
+ * @param  rssi   [in] uint8_t RSSI returned by si470x_seekTune_finished(), 0 if SF/BL was set
+ * @return true   if a failed seek switched to a more sensitive preset, a new seek is worth it
+ * @return false  if nothing more can be done with another preset
+ */
+bool fm_seekSens_seekFinished(uint8_t rssi);
+
+/**
+ * @brief Restore scores saved before last power-off. Next seek uses the
+ *        preset with the best score.
+ *
+ * @param ptrScores [in] FM_SEEK_SENSITIVITY_MAX scores, as given by fm_seekSens_export()
+ */
+void fm_seekSens_import(const uint8_t *ptrScores);
+
+/**
+ * @brief Copy scores, to be saved into non volatile memory
+ *
+ * @param ptrScores [out] buffer of FM_SEEK_SENSITIVITY_MAX scores
+ */
+void fm_seekSens_export(uint8_t *ptrScores);
+
+#endif /* _SI470X_SEEKSENS_H_ */
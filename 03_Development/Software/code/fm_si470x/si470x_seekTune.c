@@ -0,0 +1,236 @@
+/**
+ * @file    si470x_seekTune.c
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Seek and tune engine. See si470x_seekTune.h
+ *
+ *          IDLE --(intent in queue, STC cleared)--> BUSY
+ *          IDLE --(SEEK/TUNE could not be set)----> IDLE + callback NOT_STARTED
+ *          BUSY --(STC set: GPIO2 or polling)-----> ENDING + callback OK/FAILED
+ *          BUSY --(new intent during a seek)------> ENDING + callback CANCELLED
+ *          BUSY --(timeout)-----------------------> ENDING + callback TIMEOUT
+ *          ENDING --(STC cleared, or timeout)-----> IDLE
+ * @version 0.1
+ * @date    2023-09-13
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "si470x_seekTune.h"
+#include "si470x_seekSens.h"
+#include "si470x_region.h"
+
+static fm_seekTune_intent _queue[FM_SEEKTUNE_QUEUE_SIZE];
+static uint8_t            _queueHead;     /* Oldest intent */
+static uint8_t            _queueCount;
+static fm_seekTune_intent _active;        /* Intent in BUSY state */
+static FM_SEEKTUNE_STATE  _state;
+static uint32_t           _stateStartMs;  /* Time of entry in actual state */
+static uint32_t           _lastPollMs;    /* Time of last STC poll */
+
+/**
+ * @brief Add an intent in queue. Replaces last one if it is of the same kind:
+ * only latest seek direction or tune frequency is worth it.
+ */
+static bool fm_seekTune_push(const fm_seekTune_intent *intent);
+
+/**
+ * @brief Start oldest intent of queue
+ */
+static void fm_seekTune_startNext(void);
+
+/**
+ * @brief End active operation, notify it and wait for STC to be cleared
+ */
+static void fm_seekTune_finish(FM_SEEKTUNE_RESULT result, uint8_t rssi);
+
+void fm_seekTune_init(void)
+{
+   _queueHead   = 0x00;
+   _queueCount  = 0x00;
+   _active._op  = FM_SEEKTUNE_OP_NONE;
+   _state       = FM_SEEKTUNE_STATE_IDLE;
+   _stateStartMs = 0x00;
+   _lastPollMs   = 0x00;
+}
+
+bool fm_seekTune_requestSeek(uint8_t direction, fm_seekTune_callback callback)
+{
+   fm_seekTune_intent intent = {FM_SEEKTUNE_OP_SEEK, direction, 0x0000, callback};
+   bool retVal = false;
+
+   if((0x00 == direction) || (0x01 == direction))
+   {
+      retVal = fm_seekTune_push(&intent);
+   }
+   return retVal;
+}
+
+bool fm_seekTune_requestTune(float freq, fm_seekTune_callback callback)
+{
+   uint32_t khz    = SI470X_MHZ_TO_KHZ(freq);
+   bool     retVal = false;
+
+   if((SI470X_BAND_BOTTOM_KHZ <= khz) && (SI470X_BAND_TOP_KHZ >= khz))
+   {
+      retVal = fm_seekTune_requestTuneChannel(SI470X_KHZ_TO_CHANNEL(khz), callback);
+   }
+   return retVal;
+}
+
+bool fm_seekTune_requestTuneChannel(uint16_t channel, fm_seekTune_callback callback)
+{
+   fm_seekTune_intent intent = {FM_SEEKTUNE_OP_TUNE, 0x00, channel, callback};
+   return fm_seekTune_push(&intent);
+}
+
+void fm_seekTune_process(bool stcEvent)
+{
+   uint32_t nowMs = to_ms_since_boot(get_absolute_time());
+   uint32_t timeoutMs = 0x00;
+   uint8_t  rssi      = 0x00;
+   bool     isSeek    = false;
+   bool     complete  = false;
+
+   switch(_state)
+   {
+      case FM_SEEKTUNE_STATE_IDLE:
+         if(0 < _queueCount)
+         {
+            fm_seekTune_startNext();
+         }
+         break;
+
+      case FM_SEEKTUNE_STATE_BUSY:
+         isSeek    = (FM_SEEKTUNE_OP_SEEK == _active._op);
+         timeoutMs = isSeek ? FM_SEEKTUNE_SEEK_TIMEOUT_MS : FM_SEEKTUNE_TUNE_TIMEOUT_MS;
+
+         /* GPIO2 may also be an RDS interrupt of previous station, always check STC */
+         if((true == stcEvent) || (FM_SEEKTUNE_POLL_MS <= (nowMs - _lastPollMs)))
+         {
+            _lastPollMs = nowMs;
+            complete    = si470x_isSeekTuneComplete();
+         }
+
+         if(true == complete)
+         {
+            /* Reads result, then clears SEEK/TUNE bit */
+            rssi = si470x_seekTune_finished(isSeek);
+            fm_seekTune_finish((0 < rssi) ? FM_SEEKTUNE_RESULT_OK : FM_SEEKTUNE_RESULT_FAILED, rssi);
+         }
+         else if((true == isSeek) && (0 < _queueCount))
+         {
+            /* User wants something else, no need to finish sweep */
+            si470x_stopSeekTune();
+            fm_seekTune_finish(FM_SEEKTUNE_RESULT_CANCELLED, 0x00);
+         }
+         else if(timeoutMs <= (nowMs - _stateStartMs))
+         {
+            printf("[FM][SEEKTUNE] Timeout of operation %d\n", _active._op);
+            si470x_stopSeekTune();
+            fm_seekTune_finish(FM_SEEKTUNE_RESULT_TIMEOUT, 0x00);
+         }
+         break;
+
+      case FM_SEEKTUNE_STATE_ENDING:
+         if(true == si470x_getSTCbit())
+         {
+            _state = FM_SEEKTUNE_STATE_IDLE;
+            /* Do not wait next call for next intent */
+            if(0 < _queueCount)
+            {
+               fm_seekTune_startNext();
+            }
+         }
+         else if(FM_SEEKTUNE_END_TIMEOUT_MS <= (nowMs - _stateStartMs))
+         {
+            /* Should not happen. Try next one anyway, it will fail if Si470x still refuses */
+            printf("[FM][SEEKTUNE] STC not cleared\n");
+            _state = FM_SEEKTUNE_STATE_IDLE;
+         }
+         break;
+
+      default:
+         _state = FM_SEEKTUNE_STATE_IDLE;
+         break;
+   }
+}
+
+FM_SEEKTUNE_OP fm_seekTune_getActive(void)
+{
+   return (FM_SEEKTUNE_STATE_BUSY == _state) ? _active._op : FM_SEEKTUNE_OP_NONE;
+}
+
+bool fm_seekTune_isIdle(void)
+{
+   return ((FM_SEEKTUNE_STATE_IDLE == _state) && (0 == _queueCount));
+}
+
+static bool fm_seekTune_push(const fm_seekTune_intent *intent)
+{
+   uint8_t last = 0x00;
+
+   if(0 < _queueCount)
+   {
+      last = (_queueHead + _queueCount - 1) % FM_SEEKTUNE_QUEUE_SIZE;
+   }
+
+   if((0 < _queueCount) && ((_queue[last]._op == intent->_op) || (FM_SEEKTUNE_QUEUE_SIZE == _queueCount)))
+   {
+      _queue[last] = *intent;
+   }
+   else
+   {
+      _queue[(_queueHead + _queueCount) % FM_SEEKTUNE_QUEUE_SIZE] = *intent;
+      _queueCount++;
+   }
+   return true;
+}
+
+static void fm_seekTune_startNext(void)
+{
+   bool started = false;
+
+   _active = _queue[_queueHead];
+   _queueHead = (_queueHead + 1) % FM_SEEKTUNE_QUEUE_SIZE;
+   _queueCount--;
+
+   _stateStartMs = to_ms_since_boot(get_absolute_time());
+   _lastPollMs   = _stateStartMs;
+
+   if(FM_SEEKTUNE_OP_SEEK == _active._op)
+   {
+      /* Use sensitivity preset learned so far */
+      fm_seekSens_prepareSeek();
+      started = si470x_startSeek(_active._direction);
+   }
+   else
+   {
+      started = si470x_tuneChannel(_active._channel);
+   }
+
+   _state = FM_SEEKTUNE_STATE_BUSY;
+   if(false == started)
+   {
+      fm_seekTune_finish(FM_SEEKTUNE_RESULT_NOT_STARTED, 0x00);
+      /* No SEEK/TUNE bit set, no STC to wait for */
+      _state = FM_SEEKTUNE_STATE_IDLE;
+   }
+}
+
+static void fm_seekTune_finish(FM_SEEKTUNE_RESULT result, uint8_t rssi)
+{
+   fm_seekTune_intent ended = _active;
+
+   _active._op   = FM_SEEKTUNE_OP_NONE;
+   _state        = FM_SEEKTUNE_STATE_ENDING;
+   _stateStartMs = to_ms_since_boot(get_absolute_time());
+
+   /* Callback may queue a new intent (seek again), engine is ready for it */
+   if(NULL != ended._callback)
+   {
+      ended._callback(ended._op, result, rssi);
+   }
+}
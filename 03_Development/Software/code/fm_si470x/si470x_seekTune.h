@@ -0,0 +1,131 @@
+/**
+ * @file    si470x_seekTune.h
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Seek and tune engine. User intents (seek up/down, tune to a
+ *          frequency) are queued and executed one after the other:
+ *             - a new intent cancels a seek on going, so that turning RE2
+ *               again doesn't wait for a full band sweep
+ *             - end of seek/tune is notified by GPIO2, but STC is also
+ *               polled in case an edge was lost (GPIO2 interrupt deactivated,
+ *               mode switch...)
+ *             - every operation has a timeout, engine never stays busy
+ *             - a callback is called once an operation is finished
+ *          Si470x rule is respected: no new SEEK or TUNE until STC is cleared.
+ * @version 0.1
+ * @date    2023-09-13
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _SI470X_SEEKTUNE_H_
+#define _SI470X_SEEKTUNE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "si470x_driver.h"
+
+#define FM_SEEKTUNE_QUEUE_SIZE      4U
+#define FM_SEEKTUNE_POLL_MS         100U   /* STC polling, if no GPIO2 interrupt came */
+#define FM_SEEKTUNE_TUNE_TIMEOUT_MS 250U   /* Tune lasts 60 ms max */
+#define FM_SEEKTUNE_SEEK_TIMEOUT_MS 25000U /* Full band sweep, 60 ms per channel, 410 channels at 50 kHz spacing */
+#define FM_SEEKTUNE_END_TIMEOUT_MS  100U   /* STC cleared by Si470x after SEEK/TUNE bit cleared */
+
+typedef enum {
+   FM_SEEKTUNE_OP_NONE = 0,
+   FM_SEEKTUNE_OP_SEEK,
+   FM_SEEKTUNE_OP_TUNE
+} FM_SEEKTUNE_OP;
+
+typedef enum {
+   FM_SEEKTUNE_RESULT_OK = 0,    /* Station found, or frequency tuned */
+   FM_SEEKTUNE_RESULT_FAILED,    /* SF/BL: nothing found */
+   FM_SEEKTUNE_RESULT_CANCELLED, /* Seek stopped by a newer intent */
+   FM_SEEKTUNE_RESULT_TIMEOUT,   /* No STC in time */
+   FM_SEEKTUNE_RESULT_NOT_STARTED /* STC still set or I2C error, SEEK/TUNE bit not set */
+} FM_SEEKTUNE_RESULT;
+
+typedef enum {
+   FM_SEEKTUNE_STATE_IDLE = 0,   /* Nothing on going, next intent may start */
+   FM_SEEKTUNE_STATE_BUSY,       /* Seek or tune started, wait for STC */
+   FM_SEEKTUNE_STATE_ENDING      /* SEEK/TUNE bit cleared, wait for STC to be cleared */
+} FM_SEEKTUNE_STATE;
+
+/**
+ * @brief Called when an operation is finished
+ *
+ * @param op      [in] FM_SEEKTUNE_OP operation finished
+ * @param result  [in] FM_SEEKTUNE_RESULT how it finished
+ * @param rssi    [in] uint8_t RSSI of station if FM_SEEKTUNE_RESULT_OK, 0 otherwise
+ */
+typedef void (*fm_seekTune_callback)(FM_SEEKTUNE_OP op, FM_SEEKTUNE_RESULT result, uint8_t rssi);
+
+/**
+ * @brief One user intent
+ */
+typedef struct {
+   FM_SEEKTUNE_OP       _op;
+   uint8_t              _direction;   /* Seek: 0x01 up, 0x00 down */
+   uint16_t             _channel;     /* Tune: CHANNEL value, see si470x_region.h */
+   fm_seekTune_callback _callback;    /* May be NULL */
+} fm_seekTune_intent;
+
+/**
+ * @brief Init engine, empty queue
+ */
+void fm_seekTune_init(void);
+
+/**
+ * @brief Queue a seek. Cancels a seek on going. If a seek is already waiting
+ * in queue, it is replaced.
+ *
+ * @param direction [in] 0x01 to search up, 0x00 to search down
+ * @param callback  [in] called once seek finished, may be NULL
+ * @return true     if queued
+ * @return false    if wrong direction
+ */
+bool fm_seekTune_requestSeek(uint8_t direction, fm_seekTune_callback callback);
+
+/**
+ * @brief Queue a tune. Cancels a seek on going. If a tune is already waiting
+ * in queue, it is replaced.
+ *
+ * @param freq      [in] frequency in MHz
+ * @param callback  [in] called once tune finished, may be NULL
+ * @return true     if queued
+ * @return false    if frequency is out of band
+ */
+bool fm_seekTune_requestTune(float freq, fm_seekTune_callback callback);
+
+/**
+ * @brief Queue a tune to a channel already computed, like fm_seekTune_requestTune()
+ *
+ * @param channel   [in] CHANNEL value, see si470x_region.h
+ * @param callback  [in] called once tune finished, may be NULL
+ * @return true     if queued
+ */
+bool fm_seekTune_requestTuneChannel(uint16_t channel, fm_seekTune_callback callback);
+
+/**
+ * @brief Run engine. Call it periodically from FM state machine.
+ *
+ * @param stcEvent [in] true if a GPIO2 interrupt occurred since last call
+ */
+void fm_seekTune_process(bool stcEvent);
+
+/**
+ * @brief Get operation on going
+ *
+ * @return FM_SEEKTUNE_OP operation waiting for STC, FM_SEEKTUNE_OP_NONE if none
+ */
+FM_SEEKTUNE_OP fm_seekTune_getActive(void);
+
+/**
+ * @brief Check if engine has nothing to do
+ *
+ * @return true   if no operation on going and queue empty
+ * @return false  otherwise
+ */
+bool fm_seekTune_isIdle(void);
+
+#endif /* _SI470X_SEEKTUNE_H_ */
@@ -20,7 +20,9 @@ static epaperConfig _radioScreenConfig[EPAPER_PLACE_MAX] = {
    {10, 40, &Font24},   /* EPAPER_PLACE_ACTIVEMODE   */
    {10, 100, &Font24},  /* EPAPER_PLACE_BT_STATUS    */
    {10, 220, &Font24},  /* EPAPER_PLACE_BT_TRACK     */
-   {10, 400, &Font24}   /* EPAPER_PLACE_FM_FAVORITE  */
+   {10, 400, &Font24},  /* EPAPER_PLACE_FM_FAVORITE  */
+   {10, 100, &Font24},  /* EPAPER_PLACE_FM_STATION   */
+   {10, 220, &Font24}   /* EPAPER_PLACE_FM_RADIOTEXT */
 };
 
 bool ep_init(void)
@@ -35,6 +35,8 @@ typedef enum {
    EPAPER_PLACE_BT_STATUS,
    EPAPER_PLACE_BT_TRACK,
    EPAPER_PLACE_FM_FAVORITES,
+   EPAPER_PLACE_FM_STATION,     /* FM and BT are exclusive, FM uses BT places */
+   EPAPER_PLACE_FM_RADIOTEXT,
    /* Keep at the end */
    EPAPER_PLACE_MAX
 } EPAPER_PLACE;
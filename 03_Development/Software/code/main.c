@@ -24,6 +24,7 @@
 #include "ep_application.h"
 #include "re_application.h"
 #include "hal_main.h"
+#include "nv_application.h"
 
 /* HW includes */
 #include "hardware/gpio.h"
@@ -90,6 +91,8 @@ int main(void)
    {
       /* Infinite loop */
       radio_SM();
+      /* Write settings changes into flash, once they stopped changing */
+      nv_process();
       sleep_ms(10);
    }
 
@@ -153,6 +156,9 @@ void radio_SM(void)
          re2->tokenPush = false;
          printf("Send play pause 2\n");
       }
+
+      /* FM tuner unused meanwhile */
+      fm_backgroundProcess();
       break;
 
    case RADIO_STATE_FM:
@@ -181,22 +187,29 @@ void radio_SM(void)
       /* Rotary Encoder 2 - actions */
       if (true == re2->tokenIndirect)
       {
-         fm_startSeekChannel(0x01);
+         fm_rotaryTurn(0x01);
          re2->tokenIndirect = false;
       }
 
       if (true == re2->tokenDirect)
       {
-         fm_startSeekChannel(0x00);
+         fm_rotaryTurn(0x00);
          re2->tokenDirect = false;
       }
 
       if (true == re2->tokenPush)
       {
-         /* @todo Implement big state machine of frequency/station selecting */
+         /* Switch between seek and direct frequency tuning */
+         fm_toggleTuneMode();
+         re2->tokenPush = false;
       }
       break;
 
+   case RADIO_STATE_IDLE:
+      /* FM tuner unused */
+      fm_backgroundProcess();
+      break;
+
    default:
       break;
    }
@@ -211,6 +224,9 @@ void radio_init(void)
 
    /* Init GPIOs */
    hal_initGPIOs();
+
+   /* Non volatile memory init, before any module which restores its settings */
+   nv_init();
    
    /* Rotary Encoders init */
    re_initModule();
@@ -285,14 +301,18 @@ static void radio_getMode(void)
    }
    else
    {
-      printf("Mode IDLE\r");
-      /* In case of no mode active, clean e-paper */
-      ep_deactivate();
-      /* Deactivate modules to avoid parasite on/off due to interrupts */
-      bt_deactivate();
-      fm_deactivate();
-
-      radioState = RADIO_STATE_IDLE;
-      gpio_put(GPIO_MODE_HW, 0); /* Bluetooth module per default still active, but not using it */
+      /* Only on mode change: FM background work uses Si470x while IDLE */
+      if(RADIO_STATE_IDLE != radioState)
+      {
+         printf("Mode IDLE\n");
+         /* In case of no mode active, clean e-paper */
+         ep_deactivate();
+         /* Deactivate modules to avoid parasite on/off due to interrupts */
+         bt_deactivate();
+         fm_deactivate();
+
+         radioState = RADIO_STATE_IDLE;
+         gpio_put(GPIO_MODE_HW, 0); /* Bluetooth module per default still active, but not using it */
+      }
    }
-}
\ No newline at end of file
+}
@@ -0,0 +1,373 @@
+/**
+ * @file    nv_application.c
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Log structured key-value store in the tail of RP2040 flash.
+ *
+ *          Flash layout, NV_FLASH_SECTORS sectors at the end of flash:
+ *          | sector header | record | record | ... | 0xFF 0xFF (erased) |
+ *
+ *          - sector header: magic + sequence number. The valid sector with the
+ *            highest sequence is the active one. Header is written last when
+ *            a sector is filled with a copy of all values, so a power loss
+ *            during compaction leaves the previous sector active.
+ *          - record: key, size, CRC16 then payload, padded to 4 bytes. Last
+ *            valid record of a key wins. A torn record fails its CRC and is skipped.
+ *
+ *          XIP: code runs from the same flash. Erase and program are done by
+ *          SDK flash functions (placed in RAM) with interrupts disabled, so
+ *          that no interrupt handler is fetched from flash meanwhile. Core1
+ *          (RDS service) is locked out too, once it accepted lockout.
+ * @version 0.1
+ * @date    2023-09-05
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+#include "nv_application.h"
+
+#define NV_FLASH_OFFSET   (PICO_FLASH_SIZE_BYTES - (NV_FLASH_SECTORS * FLASH_SECTOR_SIZE))
+#define NV_SECTOR_MAGIC   0x3153564EU /* "NVS1" */
+#define NV_RECORD_EMPTY   0xFFU       /* Key of an erased (never written) record */
+#define NV_ALIGN(size)    (((size) + 3U) & ~3U)
+
+typedef struct {
+   uint32_t magic;
+   uint32_t sequence;
+} nv_sectorHeader;
+
+typedef struct {
+   uint8_t  key;
+   uint8_t  size;
+   uint16_t crc;
+} nv_recordHeader;
+
+/**
+ * @brief RAM copy of one value
+ */
+typedef struct {
+   bool     valid;   /* Value was set or loaded from flash */
+   bool     dirty;   /* Value changed, not yet in flash */
+   uint8_t  size;
+   uint8_t  data[NV_MAX_PAYLOAD];
+} nv_value;
+
+static nv_value _values[NV_KEY_MAX];
+static uint8_t  _activeSector;
+static uint32_t _activeSequence;
+static uint32_t _writePos;        /* Offset of next record inside active sector */
+static uint32_t _lastChangeMs;    /* Time of last nv_set() which changed something */
+static bool     _pendingCommit;
+
+/**
+ * @brief Compute CRC16-CCITT of a record
+ */
+static uint16_t nv_crc16(uint8_t key, uint8_t size, const uint8_t *data);
+
+/**
+ * @brief Read records of a sector into RAM copy
+ * @return offset of first free place in sector
+ */
+static uint32_t nv_loadSector(uint8_t sector);
+
+/**
+ * @brief Program bytes at any offset of flash. Only bits at 1 are written to 0,
+ * so rest of pages are programmed with 0xFF and stays as it is.
+ */
+static void nv_flashProgram(uint32_t offset, const uint8_t *data, uint32_t size);
+
+/**
+ * @brief Stop core1 and interrupts before an erase or program of flash
+ * @return interrupts state, for nv_flashUnlock()
+ */
+static uint32_t nv_flashLock(void);
+
+/**
+ * @brief Restart interrupts and core1 after an erase or program of flash
+ */
+static void nv_flashUnlock(uint32_t interrupts);
+
+/**
+ * @brief Append one value record to active sector at _writePos
+ */
+static void nv_appendRecord(NV_KEY key);
+
+/**
+ * @brief Copy all values into next sector, then activate it
+ */
+static void nv_compact(void);
+
+/**
+ * @brief Write all dirty values into flash
+ */
+static void nv_commit(void);
+
+static inline const uint8_t* nv_sectorPtr(uint8_t sector)
+{
+   return (const uint8_t *)(XIP_BASE + NV_FLASH_OFFSET + (sector * FLASH_SECTOR_SIZE));
+}
+
+void nv_init(void)
+{
+   uint8_t  sector      = 0x00;
+   bool     sectorFound = false;
+   const nv_sectorHeader *header;
+
+   memset(&_values[0], 0, sizeof(_values));
+   _pendingCommit = false;
+   _lastChangeMs  = 0x00;
+
+   /* Find active sector, the one with highest sequence */
+   for(sector = 0; sector < NV_FLASH_SECTORS; sector++)
+   {
+      header = (const nv_sectorHeader *)nv_sectorPtr(sector);
+      if((NV_SECTOR_MAGIC == header->magic)
+      && ((false == sectorFound) || (header->sequence > _activeSequence)))
+      {
+         _activeSector   = sector;
+         _activeSequence = header->sequence;
+         sectorFound     = true;
+      }
+   }
+
+   if(true == sectorFound)
+   {
+      _writePos = nv_loadSector(_activeSector);
+      printf("[NV][API] Init, sector %d (seq %lu), %lu bytes used\n", _activeSector, (unsigned long)_activeSequence, (unsigned long)_writePos);
+   }
+   else
+   {
+      /* Virgin flash, or layout changed: start a new log. Compaction goes to next sector, so start from last one */
+      printf("[NV][API] Init, no store found, format\n");
+      _activeSector   = NV_FLASH_SECTORS - 1;
+      _activeSequence = 0x00;
+      nv_compact();
+   }
+}
+
+bool nv_get(NV_KEY key, void *ptrData, uint16_t size)
+{
+   bool retVal = false;
+
+   if((NV_KEY_MAX > key) && (true == _values[key].valid) && (_values[key].size == size))
+   {
+      memcpy(ptrData, &_values[key].data[0], size);
+      retVal = true;
+   }
+   return retVal;
+}
+
+bool nv_set(NV_KEY key, const void *ptrData, uint16_t size)
+{
+   bool retVal = false;
+
+   if((NV_KEY_MAX > key) && (NV_MAX_PAYLOAD >= size))
+   {
+      /* Write only if something changed */
+      if((false == _values[key].valid)
+      || (_values[key].size != size)
+      || (0 != memcmp(&_values[key].data[0], ptrData, size)))
+      {
+         memcpy(&_values[key].data[0], ptrData, size);
+         _values[key].size  = (uint8_t)size;
+         _values[key].valid = true;
+         _values[key].dirty = true;
+         _pendingCommit     = true;
+         _lastChangeMs      = to_ms_since_boot(get_absolute_time());
+      }
+      retVal = true;
+   }
+   return retVal;
+}
+
+void nv_process(void)
+{
+   if((true == _pendingCommit)
+   && (NV_COMMIT_DELAY_MS <= (to_ms_since_boot(get_absolute_time()) - _lastChangeMs)))
+   {
+      nv_commit();
+   }
+}
+
+void nv_flush(void)
+{
+   if(true == _pendingCommit)
+   {
+      nv_commit();
+   }
+}
+
+static void nv_commit(void)
+{
+   uint8_t key = 0x00;
+
+   for(key = 0; key < NV_KEY_MAX; key++)
+   {
+      if(true == _values[key].dirty)
+      {
+         if(FLASH_SECTOR_SIZE < (_writePos + sizeof(nv_recordHeader) + NV_ALIGN(_values[key].size)))
+         {
+            /* Sector full. Compaction writes all values, dirty ones included */
+            nv_compact();
+            break;
+         }
+         nv_appendRecord((NV_KEY)key);
+         _values[key].dirty = false;
+      }
+   }
+   _pendingCommit = false;
+   printf("[NV][API] Commit done, %lu bytes used\n", (unsigned long)_writePos);
+}
+
+static void nv_compact(void)
+{
+   uint8_t nextSector = (_activeSector + 1) % NV_FLASH_SECTORS;
+   nv_sectorHeader header = {NV_SECTOR_MAGIC, _activeSequence + 1};
+   uint32_t flashOffset = NV_FLASH_OFFSET + (nextSector * FLASH_SECTOR_SIZE);
+   uint32_t interrupts;
+   uint8_t  key = 0x00;
+
+   interrupts = nv_flashLock();
+   flash_range_erase(flashOffset, FLASH_SECTOR_SIZE);
+   nv_flashUnlock(interrupts);
+
+   _activeSector = nextSector;
+   _writePos     = sizeof(nv_sectorHeader);
+   for(key = 0; key < NV_KEY_MAX; key++)
+   {
+      if(true == _values[key].valid)
+      {
+         nv_appendRecord((NV_KEY)key);
+      }
+      _values[key].dirty = false;
+   }
+
+   /* All values copied, sector may become the active one */
+   nv_flashProgram(flashOffset, (const uint8_t *)&header, sizeof(header));
+   _activeSequence = header.sequence;
+   printf("[NV][API] Compaction into sector %d (seq %lu)\n", _activeSector, (unsigned long)_activeSequence);
+}
+
+static void nv_appendRecord(NV_KEY key)
+{
+   uint8_t record[sizeof(nv_recordHeader) + NV_MAX_PAYLOAD];
+   nv_recordHeader header;
+   uint32_t recordSize = sizeof(nv_recordHeader) + NV_ALIGN(_values[key].size);
+
+   header.key  = (uint8_t)key;
+   header.size = _values[key].size;
+   header.crc  = nv_crc16(header.key, header.size, &_values[key].data[0]);
+
+   memset(&record[0], 0xFF, sizeof(record));
+   memcpy(&record[0], &header, sizeof(header));
+   memcpy(&record[sizeof(header)], &_values[key].data[0], header.size);
+
+   nv_flashProgram(NV_FLASH_OFFSET + (_activeSector * FLASH_SECTOR_SIZE) + _writePos, &record[0], recordSize);
+   _writePos += recordSize;
+}
+
+static uint32_t nv_loadSector(uint8_t sector)
+{
+   const uint8_t *sectorData = nv_sectorPtr(sector);
+   const nv_recordHeader *header;
+   uint32_t pos = sizeof(nv_sectorHeader);
+
+   while(FLASH_SECTOR_SIZE >= (pos + sizeof(nv_recordHeader)))
+   {
+      header = (const nv_recordHeader *)&sectorData[pos];
+
+      /* End of log */
+      if(NV_RECORD_EMPTY == header->key)
+      {
+         break;
+      }
+      /* Size not readable, no way to find next record. Next commit will compact */
+      if((NV_MAX_PAYLOAD < header->size)
+      || (FLASH_SECTOR_SIZE < (pos + sizeof(nv_recordHeader) + NV_ALIGN(header->size))))
+      {
+         printf("[NV][ERROR] Corrupted record at %lu\n", (unsigned long)pos);
+         pos = FLASH_SECTOR_SIZE;
+         break;
+      }
+
+      if((NV_KEY_MAX > header->key)
+      && (header->crc == nv_crc16(header->key, header->size, &sectorData[pos + sizeof(nv_recordHeader)])))
+      {
+         memcpy(&_values[header->key].data[0], &sectorData[pos + sizeof(nv_recordHeader)], header->size);
+         _values[header->key].size  = header->size;
+         _values[header->key].valid = true;
+      }
+      pos += sizeof(nv_recordHeader) + NV_ALIGN(header->size);
+   }
+   return pos;
+}
+
+static uint32_t nv_flashLock(void)
+{
+   /* Core1 waits in RAM, it fetches nothing from flash meanwhile */
+   if(true == multicore_lockout_victim_is_initialized(1))
+   {
+      multicore_lockout_start_blocking();
+   }
+   return save_and_disable_interrupts();
+}
+
+static void nv_flashUnlock(uint32_t interrupts)
+{
+   restore_interrupts(interrupts);
+   if(true == multicore_lockout_victim_is_initialized(1))
+   {
+      multicore_lockout_end_blocking();
+   }
+}
+
+static void nv_flashProgram(uint32_t offset, const uint8_t *data, uint32_t size)
+{
+   uint8_t  pageBuffer[FLASH_PAGE_SIZE];
+   uint32_t pageOffset = offset & ~(FLASH_PAGE_SIZE - 1);
+   uint32_t inPage     = offset - pageOffset;
+   uint32_t chunk      = 0x00;
+   uint32_t interrupts;
+
+   /* Flash is programmed per pages of 256 bytes */
+   while(0 < size)
+   {
+      chunk = MIN(size, FLASH_PAGE_SIZE - inPage);
+      memset(&pageBuffer[0], 0xFF, FLASH_PAGE_SIZE);
+      memcpy(&pageBuffer[inPage], data, chunk);
+
+      interrupts = nv_flashLock();
+      flash_range_program(pageOffset, &pageBuffer[0], FLASH_PAGE_SIZE);
+      nv_flashUnlock(interrupts);
+
+      data       += chunk;
+      size       -= chunk;
+      pageOffset += FLASH_PAGE_SIZE;
+      inPage      = 0x00;
+   }
+}
+
+static uint16_t nv_crc16(uint8_t key, uint8_t size, const uint8_t *data)
+{
+   uint16_t crc   = 0xFFFF;
+   uint16_t index = 0x00;
+   uint8_t  bit   = 0x00;
+   uint8_t  byte  = 0x00;
+
+   for(index = 0; index < (size + 2U); index++)
+   {
+      /* Key and size are part of the CRC */
+      byte = (0 == index) ? key : ((1 == index) ? size : data[index - 2U]);
+      crc ^= (uint16_t)byte << 8;
+      for(bit = 0; bit < 8; bit++)
+      {
+         crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+      }
+   }
+   return crc;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file    nv_application.h
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Small non volatile key-value store in the tail of RP2040 flash.
+ *          It keeps what should survive a power-off: FM presets, last
+ *          station, volume, RDS names and seek sensitivity scores.
+ *
+ *          Store is a log: every change is appended as a new record after the
+ *          previous ones, nothing is erased until the sector is full. Then the
+ *          last value of each key is copied into the next sector (round robin
+ *          over NV_FLASH_SECTORS sectors) so that erase cycles are spread.
+ *
+ *          Writes are deferred: nv_set() only updates a RAM copy. nv_process()
+ *          writes all changed keys in one batch once nothing changed for
+ *          NV_COMMIT_DELAY_MS. Turning a rotary encoder will not wear flash.
+ * @version 0.1
+ * @date    2023-09-05
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef NV_APPLICATION_H
+#define NV_APPLICATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+
+#define NV_FLASH_SECTORS      4U     /* Sectors of 4 kB used at the end of flash */
+#define NV_MAX_PAYLOAD        240U   /* Max bytes of one value */
+#define NV_COMMIT_DELAY_MS    5000U  /* Quiet time before writing changes into flash */
+
+/**
+ * @brief All values saved into non volatile memory.
+ * @warning Only add keys at the end, their values are saved in flash
+ */
+typedef enum {
+   NV_KEY_FM_PRESETS = 0,  /* fm_station_preset array */
+   NV_KEY_FM_LASTFREQ,     /* float, last station listened */
+   NV_KEY_FM_VOLUME,       /* uint8_t, Si470x volume */
+   NV_KEY_UNUSED_3,        /* Free, keeps number of following keys */
+   NV_KEY_RDS_CACHE,       /* rds_cachePersist array, PS names of last stations */
+   NV_KEY_FM_SEEKSENS,     /* uint8_t array of FM_SEEK_SENSITIVITY_MAX, seek preset scores */
+   /* Keep at the end */
+   NV_KEY_MAX
+} NV_KEY;
+
+/**
+ * @brief Find active flash sector and load all saved values into RAM.
+ * Must be called before any other nv_ function
+ */
+void nv_init(void);
+
+/**
+ * @brief Get a saved value
+ *
+ * @param key     [in]  NV_KEY value to get
+ * @param ptrData [out] pointer to buffer of at least size bytes
+ * @param size    [in]  size of expected value
+ * @return true   if value exists and has expected size
+ * @return false  if never saved, or saved with another size (structure changed)
+ */
+bool nv_get(NV_KEY key, void *ptrData, uint16_t size);
+
+/**
+ * @brief Set a value. It is only written into flash by nv_process(), after
+ * NV_COMMIT_DELAY_MS without any other change.
+ *
+ * @param key     [in] NV_KEY value to set
+ * @param ptrData [in] pointer to value
+ * @param size    [in] size of value, up to NV_MAX_PAYLOAD
+ * @return true   if accepted
+ * @return false  if key or size are wrong
+ */
+bool nv_set(NV_KEY key, const void *ptrData, uint16_t size);
+
+/**
+ * @brief Write changed values into flash if they are waiting since long enough.
+ * Call it periodically from main loop.
+ */
+void nv_process(void);
+
+/**
+ * @brief Write changed values into flash now, without waiting
+ */
+void nv_flush(void);
+
+#endif /* NV_APPLICATION_H */
@@ -0,0 +1,186 @@
+/**
+ * @file    rdsCache.c
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Cache of RDS metadata of last stations listened. See rdsCache.h
+ * @version 0.1
+ * @date    2023-09-09
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include "rdsCache.h"
+#include <string.h>
+
+/////////////////////////// GLOBAL VARIABLES ///////////////////////////////////
+static rds_cacheEntry _RDS_cache[RDS_CACHE_ENTRIES];
+static uint32_t       _RDS_cacheUseCounter;
+
+/**
+ * @brief Get entry of a station, or reuse least recently used one
+ */
+static rds_cacheEntry* rdsCache_getOrCreate(uint16_t pi, uint16_t channel);
+
+void rdsCache_init(void)
+{
+   memset(&_RDS_cache[0], 0, sizeof(_RDS_cache));
+   _RDS_cacheUseCounter = 0x00;
+}
+
+const rds_cacheEntry* rdsCache_find(uint16_t pi, uint16_t channel)
+{
+   rds_cacheEntry *found = NULL;
+   uint8_t index = 0x00;
+
+   for(index = 0; index < RDS_CACHE_ENTRIES; index++)
+   {
+      if((RDS_CACHE_PI_UNKNOWN != _RDS_cache[index]._pi)
+      && (channel == _RDS_cache[index]._channel)
+      && ((RDS_CACHE_PI_UNKNOWN == pi) || (pi == _RDS_cache[index]._pi)))
+      {
+         /* Several PI on same channel (travel), take most recent one */
+         if((NULL == found) || (_RDS_cache[index]._lastUse > found->_lastUse))
+         {
+            found = &_RDS_cache[index];
+         }
+      }
+   }
+
+   if(NULL != found)
+   {
+      found->_lastUse = ++_RDS_cacheUseCounter;
+   }
+   return found;
+}
+
+bool rdsCache_storePS(uint16_t pi, uint16_t channel, const uint8_t *ps, uint8_t pty)
+{
+   bool changed = false;
+   rds_cacheEntry *entry = rdsCache_getOrCreate(pi, channel);
+
+   if(NULL != entry)
+   {
+      if((false == entry->_psValid)
+      || (pty != entry->_pty)
+      || (0 != memcmp(&entry->_ps[0], ps, PS_GROUP_MAX_CHARS)))
+      {
+         memcpy(&entry->_ps[0], ps, PS_GROUP_MAX_CHARS);
+         entry->_pty     = pty;
+         entry->_psValid = true;
+         changed         = true;
+      }
+   }
+   return changed;
+}
+
+void rdsCache_storeRT(uint16_t pi, uint16_t channel, const uint8_t *rt, uint8_t size)
+{
+   rds_cacheEntry *entry = rdsCache_getOrCreate(pi, channel);
+
+   if(NULL != entry)
+   {
+      entry->_rtSize = (size > RT_GROUP_MAX_CHARS) ? RT_GROUP_MAX_CHARS : size;
+      memcpy(&entry->_rt[0], rt, entry->_rtSize);
+   }
+}
+
+void rdsCache_storeAF(uint16_t pi, uint16_t channel, const uint8_t *afList, uint8_t count)
+{
+   rds_cacheEntry *entry = rdsCache_getOrCreate(pi, channel);
+
+   if(NULL != entry)
+   {
+      entry->_afCount = (count > AF_MAX_FREQS) ? AF_MAX_FREQS : count;
+      memcpy(&entry->_af[0], afList, entry->_afCount);
+   }
+}
+
+uint8_t rdsCache_getAF(uint16_t pi, uint8_t *afList)
+{
+   const rds_cacheEntry *best = NULL;
+   uint8_t index = 0x00;
+   uint8_t count = 0x00;
+
+   for(index = 0; index < RDS_CACHE_ENTRIES; index++)
+   {
+      if((RDS_CACHE_PI_UNKNOWN != pi) && (pi == _RDS_cache[index]._pi)
+      && ((NULL == best) || (_RDS_cache[index]._afCount > best->_afCount)))
+      {
+         best = &_RDS_cache[index];
+      }
+   }
+
+   if(NULL != best)
+   {
+      count = best->_afCount;
+      memcpy(afList, &best->_af[0], count);
+   }
+   return count;
+}
+
+void rdsCache_export(rds_cachePersist *table)
+{
+   uint8_t index = 0x00;
+
+   memset(table, 0, RDS_CACHE_ENTRIES * sizeof(rds_cachePersist));
+   for(index = 0; index < RDS_CACHE_ENTRIES; index++)
+   {
+      /* Only stations with a full PS name are worth it */
+      if(true == _RDS_cache[index]._psValid)
+      {
+         table[index]._pi      = _RDS_cache[index]._pi;
+         table[index]._channel = _RDS_cache[index]._channel;
+         table[index]._pty     = _RDS_cache[index]._pty;
+         memcpy(&table[index]._ps[0], &_RDS_cache[index]._ps[0], PS_GROUP_MAX_CHARS);
+      }
+   }
+}
+
+void rdsCache_import(const rds_cachePersist *table)
+{
+   uint8_t index = 0x00;
+
+   rdsCache_init();
+   for(index = 0; index < RDS_CACHE_ENTRIES; index++)
+   {
+      if(RDS_CACHE_PI_UNKNOWN != table[index]._pi)
+      {
+         _RDS_cache[index]._pi      = table[index]._pi;
+         _RDS_cache[index]._channel = table[index]._channel;
+         _RDS_cache[index]._pty     = table[index]._pty;
+         _RDS_cache[index]._psValid = true;
+         memcpy(&_RDS_cache[index]._ps[0], &table[index]._ps[0], PS_GROUP_MAX_CHARS);
+         /* Keep saved order as LRU order */
+         _RDS_cache[index]._lastUse = ++_RDS_cacheUseCounter;
+      }
+   }
+}
+
+static rds_cacheEntry* rdsCache_getOrCreate(uint16_t pi, uint16_t channel)
+{
+   rds_cacheEntry *entry = NULL;
+   uint8_t index = 0x00;
+
+   if(RDS_CACHE_PI_UNKNOWN != pi)
+   {
+      entry = (rds_cacheEntry *)rdsCache_find(pi, channel);
+
+      if(NULL == entry)
+      {
+         /* Free entries have _lastUse = 0, they are taken first */
+         entry = &_RDS_cache[0];
+         for(index = 1; index < RDS_CACHE_ENTRIES; index++)
+         {
+            if(_RDS_cache[index]._lastUse < entry->_lastUse)
+            {
+               entry = &_RDS_cache[index];
+            }
+         }
+
+         memset(entry, 0, sizeof(rds_cacheEntry));
+         entry->_pi      = pi;
+         entry->_channel = channel;
+         entry->_lastUse = ++_RDS_cacheUseCounter;
+      }
+   }
+   return entry;
+}
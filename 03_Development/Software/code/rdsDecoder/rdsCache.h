@@ -0,0 +1,138 @@
+/**
+ * @file    rdsCache.h
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Cache of RDS metadata of last stations listened. Entries are keyed
+ *          by PI (programme identification) and channel, and are replaced
+ *          with a least recently used policy.
+ *          After a seek or tune, cached PS name and RT message of the station
+ *          can be shown immediately, then confirmed or replaced by freshly
+ *          decoded RDS groups.
+ *          PI is only known after first RDS group, so a lookup with
+ *          RDS_CACHE_PI_UNKNOWN only uses channel.
+ *          AF lists belong to a programme, not to a channel: they are looked
+ *          up by PI only.
+ * @version 0.1
+ * @date    2023-09-09
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _RDS_CACHE_H_
+#define _RDS_CACHE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rdsDecoder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RDS_CACHE_ENTRIES     8U
+#define RDS_CACHE_PI_UNKNOWN  0x0000  /* PI not yet received after tune */
+
+/**
+ * @brief RDS state of one station
+ */
+typedef struct {
+   uint16_t _pi;                            /* Programme identification, 0 if entry free */
+   uint16_t _channel;                       /* Si470x channel of station */
+   uint8_t  _pty;                           /* Programme type */
+   bool     _psValid;                       /* PS name was fully received */
+   uint8_t  _ps[PS_GROUP_MAX_CHARS];        /* Programme service name */
+   uint8_t  _rtSize;                        /* Size of last RT, 0 if none */
+   uint8_t  _rt[RT_GROUP_MAX_CHARS];        /* Last RadioText message */
+   uint8_t  _afCount;                       /* Qty of AF codes, 0 if none */
+   uint8_t  _af[AF_MAX_FREQS];              /* AF codes of station */
+   uint32_t _lastUse;                       /* LRU counter */
+} rds_cacheEntry;
+
+/**
+ * @brief Reduced entry to be saved in non volatile memory. RT changes with
+ * every song, it is not worth saving it.
+ */
+typedef struct {
+   uint16_t _pi;
+   uint16_t _channel;
+   uint8_t  _pty;
+   uint8_t  _ps[PS_GROUP_MAX_CHARS];
+} rds_cachePersist;
+
+/**
+ * @brief Empty cache
+ */
+void rdsCache_init(void);
+
+/**
+ * @brief Find a station in cache. Marks entry as recently used.
+ *
+ * @param pi       [in] PI of station, or RDS_CACHE_PI_UNKNOWN to search by channel only
+ * @param channel  [in] channel of station
+ * @return const rds_cacheEntry* entry found, NULL if not in cache
+ */
+const rds_cacheEntry* rdsCache_find(uint16_t pi, uint16_t channel);
+
+/**
+ * @brief Save PS name and PTY of a station. Creates entry if needed, by
+ * replacing least recently used one.
+ *
+ * @param pi       [in] PI of station, must be known
+ * @param channel  [in] channel of station
+ * @param ps       [in] PS_GROUP_MAX_CHARS characters of PS name
+ * @param pty      [in] programme type
+ * @return true    if PS or PTY changed compared to cached one
+ * @return false   if the same was already cached
+ */
+bool rdsCache_storePS(uint16_t pi, uint16_t channel, const uint8_t *ps, uint8_t pty);
+
+/**
+ * @brief Save last RadioText of a station. Creates entry if needed.
+ *
+ * @param pi       [in] PI of station, must be known
+ * @param channel  [in] channel of station
+ * @param rt       [in] RT message
+ * @param size     [in] number of characters of RT, up to RT_GROUP_MAX_CHARS
+ */
+void rdsCache_storeRT(uint16_t pi, uint16_t channel, const uint8_t *rt, uint8_t size);
+
+/**
+ * @brief Save AF list of a station. Creates entry if needed.
+ *
+ * @param pi       [in] PI of station, must be known
+ * @param channel  [in] channel of station
+ * @param afList   [in] AF codes, see rdsDecoder_getAF()
+ * @param count    [in] qty of AF codes, up to AF_MAX_FREQS
+ */
+void rdsCache_storeAF(uint16_t pi, uint16_t channel, const uint8_t *afList, uint8_t count);
+
+/**
+ * @brief Get the longest AF list known for a programme, whatever the channel
+ * it was received on.
+ *
+ * @param pi       [in]  PI of programme
+ * @param afList   [out] buffer of AF_MAX_FREQS AF codes
+ * @return uint8_t qty of AF codes copied, 0 if none known
+ */
+uint8_t rdsCache_getAF(uint16_t pi, uint8_t *afList);
+
+/**
+ * @brief Fill a table to save cache into non volatile memory. Free entries
+ * have a PI equal to RDS_CACHE_PI_UNKNOWN.
+ *
+ * @param table [out] table of RDS_CACHE_ENTRIES elements
+ */
+void rdsCache_export(rds_cachePersist *table);
+
+/**
+ * @brief Restore cache from a table saved with rdsCache_export()
+ *
+ * @param table [in] table of RDS_CACHE_ENTRIES elements
+ */
+void rdsCache_import(const rds_cachePersist *table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _RDS_CACHE_H_
@@ -0,0 +1,151 @@
+/**
+ * @file    rdsCapture.c
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Capture format of RDS groups. See rdsCapture.h
+ * @version 0.1
+ * @date    2023-09-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <string.h>
+#include "rdsCapture.h"
+
+static const uint8_t _magic[4] = {'R', 'D', 'S', 'C'};
+static const char    _hex[16]  = {'0', '1', '2', '3', '4', '5', '6', '7',
+                                  '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+
+/**
+ * @brief Value of an hexadecimal character, 0xFF if it is not one
+ */
+static uint8_t rdsCapture_hexValue(char character);
+
+static inline void rdsCapture_put16(uint8_t *buffer, uint16_t value)
+{
+   buffer[0] = (uint8_t)(value & 0x00FF);
+   buffer[1] = (uint8_t)((value & 0xFF00) >> 8);
+}
+
+static inline uint16_t rdsCapture_get16(const uint8_t *buffer)
+{
+   return (uint16_t)(buffer[0] | (buffer[1] << 8));
+}
+
+void rdsCapture_writeHeader(uint8_t *buffer)
+{
+   memcpy(buffer, &_magic[0], sizeof(_magic));
+   buffer[4] = RDS_CAPTURE_VERSION;
+   buffer[5] = RDS_CAPTURE_RECORD_SIZE;
+   buffer[6] = 0x00;
+   buffer[7] = 0x00;
+}
+
+bool rdsCapture_checkHeader(const uint8_t *buffer)
+{
+   return ((0 == memcmp(buffer, &_magic[0], sizeof(_magic)))
+        && (RDS_CAPTURE_VERSION == buffer[4])
+        && (RDS_CAPTURE_RECORD_SIZE == buffer[5]));
+}
+
+void rdsCapture_encode(uint8_t *buffer, const rds_captureRecord *record)
+{
+   rdsCapture_put16(&buffer[0], (uint16_t)(record->_timeMs & 0xFFFF));
+   rdsCapture_put16(&buffer[2], (uint16_t)(record->_timeMs >> 16));
+   rdsCapture_put16(&buffer[4],  record->_group.block_A);
+   rdsCapture_put16(&buffer[6],  record->_group.block_B);
+   rdsCapture_put16(&buffer[8],  record->_group.block_C);
+   rdsCapture_put16(&buffer[10], record->_group.block_D);
+   buffer[12] = (uint8_t)(((record->_group.bler_A & 0x03) << 6) | ((record->_group.bler_B & 0x03) << 4)
+                        | ((record->_group.bler_C & 0x03) << 2) |  (record->_group.bler_D & 0x03));
+   buffer[13] = record->_rssi;
+   buffer[14] = record->_flags;
+   buffer[15] = 0x00;
+}
+
+void rdsCapture_decode(const uint8_t *buffer, rds_captureRecord *record)
+{
+   record->_timeMs        = (uint32_t)rdsCapture_get16(&buffer[0]) | ((uint32_t)rdsCapture_get16(&buffer[2]) << 16);
+   record->_group.block_A = rdsCapture_get16(&buffer[4]);
+   record->_group.block_B = rdsCapture_get16(&buffer[6]);
+   record->_group.block_C = rdsCapture_get16(&buffer[8]);
+   record->_group.block_D = rdsCapture_get16(&buffer[10]);
+   record->_group.bler_A  = (buffer[12] >> 6) & 0x03;
+   record->_group.bler_B  = (buffer[12] >> 4) & 0x03;
+   record->_group.bler_C  = (buffer[12] >> 2) & 0x03;
+   record->_group.bler_D  =  buffer[12]       & 0x03;
+   record->_rssi          = buffer[13];
+   record->_flags         = buffer[14];
+}
+
+void rdsCapture_toLine(char *line, const rds_captureRecord *record)
+{
+   uint8_t buffer[RDS_CAPTURE_RECORD_SIZE];
+   uint8_t index    = 0x00;
+   uint8_t position = sizeof(RDS_CAPTURE_LINE_PREFIX) - 1U;
+
+   rdsCapture_encode(&buffer[0], record);
+   memcpy(line, RDS_CAPTURE_LINE_PREFIX, position);
+   for(index = 0; index < RDS_CAPTURE_RECORD_SIZE; index++)
+   {
+      line[position++] = _hex[buffer[index] >> 4];
+      line[position++] = _hex[buffer[index] & 0x0F];
+   }
+   line[position++] = '\n';
+   line[position]   = '\0';
+}
+
+bool rdsCapture_fromLine(const char *line, rds_captureRecord *record)
+{
+   uint8_t     buffer[RDS_CAPTURE_RECORD_SIZE];
+   uint8_t     index  = 0x00;
+   uint8_t     high   = 0x00;
+   uint8_t     low    = 0x00;
+   bool        retVal = false;
+   const char *hex    = strstr(line, RDS_CAPTURE_LINE_PREFIX);
+
+   if(NULL != hex)
+   {
+      hex   += sizeof(RDS_CAPTURE_LINE_PREFIX) - 1U;
+      retVal = true;
+      /* strlen() not needed: '\0' is not an hexadecimal character */
+      for(index = 0; (index < RDS_CAPTURE_RECORD_SIZE) && (true == retVal); index++)
+      {
+         high = rdsCapture_hexValue(hex[2U * index]);
+         low  = (0xFF != high) ? rdsCapture_hexValue(hex[(2U * index) + 1U]) : 0xFF;
+         if((0xFF == high) || (0xFF == low))
+         {
+            retVal = false;
+         }
+         else
+         {
+            buffer[index] = (uint8_t)((high << 4) | low);
+         }
+      }
+   }
+
+   if(true == retVal)
+   {
+      rdsCapture_decode(&buffer[0], record);
+   }
+   return retVal;
+}
+
+static uint8_t rdsCapture_hexValue(char character)
+{
+   uint8_t retVal = 0xFF;
+
+   if(('0' <= character) && ('9' >= character))
+   {
+      retVal = (uint8_t)(character - '0');
+   }
+   else if(('A' <= character) && ('F' >= character))
+   {
+      retVal = (uint8_t)(character - 'A' + 10);
+   }
+   else if(('a' <= character) && ('f' >= character))
+   {
+      retVal = (uint8_t)(character - 'a' + 10);
+   }
+   return retVal;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file    rdsCapture.h
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Capture format of RDS groups, shared by the radio (recorder) and
+ *          host tools (replay, benchmark). Groups of real stations are played
+ *          again through rdsDecoder, off the radio.
+ *
+ *          File: one header, then records. All fields are little endian.
+ *          | header 8 bytes | record 16 bytes | record 16 bytes | ...
+ *
+ *          Header:  "RDSC" | version | record size | 0x00 0x00
+ *          Record:  time (ms, u32) | block A..D (u16 each) | BLER A..D (2 bits
+ *                   each, A in MSB) | RSSI | flags | 0x00
+ *
+ *          Over UART, the radio mixes records with its logs: each record is
+ *          one text line "$RDS," followed by its 16 bytes in hexadecimal.
+ *          Host tools convert such a log into a capture file.
+ * @version 0.1
+ * @date    2023-09-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef _RDS_CAPTURE_H_
+#define _RDS_CAPTURE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rdsDecoder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RDS_CAPTURE_VERSION           1U
+#define RDS_CAPTURE_HEADER_SIZE       8U
+#define RDS_CAPTURE_RECORD_SIZE       16U
+#define RDS_CAPTURE_LINE_PREFIX       "$RDS,"
+#define RDS_CAPTURE_LINE_SIZE         (5U + (2U * RDS_CAPTURE_RECORD_SIZE) + 2U) /* Prefix, hexadecimal, '\n' and '\0' */
+
+#define RDS_CAPTURE_FLAG_NEW_STATION  0x01U  /* First group after a seek or tune: decoder is reset */
+
+/**
+ * @brief One captured group
+ */
+typedef struct {
+   uint32_t        _timeMs;    /* Time of capture, only differences between records matter */
+   rds_groupBlocks _group;     /* Blocks and BLER */
+   uint8_t         _rssi;      /* RSSI at capture, 0 if unknown */
+   uint8_t         _flags;     /* RDS_CAPTURE_FLAG_... */
+} rds_captureRecord;
+
+/**
+ * @brief Write file header
+ *
+ * @param buffer [out] RDS_CAPTURE_HEADER_SIZE bytes
+ */
+void rdsCapture_writeHeader(uint8_t *buffer);
+
+/**
+ * @brief Check file header
+ *
+ * @param buffer  [in] RDS_CAPTURE_HEADER_SIZE bytes
+ * @return true   if it is a capture of a known version
+ */
+bool rdsCapture_checkHeader(const uint8_t *buffer);
+
+/**
+ * @brief Encode a record
+ *
+ * @param buffer [out] RDS_CAPTURE_RECORD_SIZE bytes
+ * @param record [in]  record to encode
+ */
+void rdsCapture_encode(uint8_t *buffer, const rds_captureRecord *record);
+
+/**
+ * @brief Decode a record
+ *
+ * @param buffer [in]  RDS_CAPTURE_RECORD_SIZE bytes
+ * @param record [out] decoded record
+ */
+void rdsCapture_decode(const uint8_t *buffer, rds_captureRecord *record);
+
+/**
+ * @brief Encode a record as a UART line, '\n' and '\0' terminated
+ *
+ * @param line   [out] RDS_CAPTURE_LINE_SIZE characters
+ * @param record [in]  record to encode
+ */
+void rdsCapture_toLine(char *line, const rds_captureRecord *record);
+
+/**
+ * @brief Decode a UART line. Anything before RDS_CAPTURE_LINE_PREFIX is ignored.
+ *
+ * @param line    [in]  '\0' terminated line
+ * @param record  [out] decoded record
+ * @return true   if line holds a record
+ * @return false  if it is a log line
+ */
+bool rdsCapture_fromLine(const char *line, rds_captureRecord *record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RDS_CAPTURE_H_ */
@@ -2,9 +2,10 @@
  * @file rdsDecoder.c
  * @author  Kureciplatek (galleej@gmail.com)
  * @brief   RDS decoder. Use it to decode the 4 RDS blocks reeived by Si470x module or
- *          any other FM receiver module (as RDS is standard). It is static and has an
- *          inernal buffer of memory to, step-by-step decode RDS data and place it in
- *          its rightful place.
+ *          any other FM receiver module (as RDS is standard). All state of one
+ *          RDS stream is in an rds_decoder instance, given to every _r function:
+ *          several streams can be decoded at once, one instance each.
+ *          Functions without _r use the default instance, as before.
  * @version 0.1
  * @date 2023-02-17
  * 
@@ -16,248 +17,799 @@
 #include <stdio.h>
 
 /////////////////////////// GLOBAL VARIABLES ///////////////////////////////////
-static rds_decoder _RDS_decoder;
+static rds_decoder _RDS_decoder;   /* Default instance, used by functions without _r */
 //static rds_ptyConverter _RDS_all_pty[PTY_NUMBER];   /* Not yet supported */
 
+/**
+ * @brief Handler of one group code. Block B common fields (PI, PTY, TP) are
+ * already decoded.
+ *
+ * @param decoder       [in]  decoder instance
+ * @param group         [in]  group to decode
+ * @param pointerToMsg  [out] RT message, if handler completed one
+ * @return uint8_t      qty of RT characters written into pointerToMsg, 0 if none
+ */
+typedef uint8_t (*rdsDecoder_groupHandler)(rds_decoder *decoder, const rds_groupBlocks *group, uint8_t *pointerToMsg);
+
+/* Group handlers */
+static uint8_t rdsDecoder_handle0A(rds_decoder *decoder, const rds_groupBlocks *group, uint8_t *pointerToMsg);
+static uint8_t rdsDecoder_handle0B(rds_decoder *decoder, const rds_groupBlocks *group, uint8_t *pointerToMsg);
+static uint8_t rdsDecoder_handle2(rds_decoder *decoder, const rds_groupBlocks *group, uint8_t *pointerToMsg);
+static uint8_t rdsDecoder_handle3A(rds_decoder *decoder, const rds_groupBlocks *group, uint8_t *pointerToMsg);
+static uint8_t rdsDecoder_handle4A(rds_decoder *decoder, const rds_groupBlocks *group, uint8_t *pointerToMsg);
+static uint8_t rdsDecoder_handle10A(rds_decoder *decoder, const rds_groupBlocks *group, uint8_t *pointerToMsg);
+static uint8_t rdsDecoder_handleODA(rds_decoder *decoder, const rds_groupBlocks *group, uint8_t *pointerToMsg);
+
+/* Dispatch table, indexed by group code (type and version). NULL: group not supported */
+static const rdsDecoder_groupHandler _groupHandlers[RDS_GROUP_CODES] =
+{
+   [GROUP_TYPE_0A]  = rdsDecoder_handle0A,
+   [GROUP_TYPE_0B]  = rdsDecoder_handle0B,
+   [GROUP_TYPE_2A]  = rdsDecoder_handle2,
+   [GROUP_TYPE_2B]  = rdsDecoder_handle2,
+   [GROUP_TYPE_3A]  = rdsDecoder_handle3A,
+   [GROUP_TYPE_4A]  = rdsDecoder_handle4A,
+   [GROUP_TYPE_10A] = rdsDecoder_handle10A,
+   [GROUP_TYPE_11A] = rdsDecoder_handleODA   /* Add here other group codes carrying ODA, if needed */
+};
+
 /* Static functions to process data from blocks */
-static void    rdsDecoder_processPS(uint16_t blockC, uint16_t blockD, uint8_t unassignedBits);
-static uint8_t rdsDecoder_processRT(uint16_t blockC, uint16_t blockD, uint8_t unassignedBits);
+static void    rdsDecoder_processPS(rds_decoder *decoder, uint16_t blockD, uint8_t unassignedBits, uint8_t weight);
+/* @brief Vote for one PS character. Returns true if a confirmed character was replaced */
+static bool    rdsDecoder_votePSChar(rds_psChar *psChar, uint8_t value, uint8_t weight);
+static uint8_t rdsDecoder_processRT(rds_decoder *decoder, uint16_t blockC, uint16_t blockD, uint8_t unassignedBits, uint8_t weight, bool versionB);
+/* @brief Mark RT segment as confirmed once all its characters meet quality level */
+static void    rdsDecoder_confirmRTSegment(rds_decoder *decoder, uint8_t segment, uint8_t nbrChars);
+/* @brief Add one event to batch result */
+static void    rdsDecoder_addEvent(rds_batchResult *result, uint16_t group, RDS_EVENT type, uint8_t value);
+/* @brief Vote for one RT character, weighted by block errors */
+static void    rdsDecoder_voteRTChar(RT_QUALITY_STATE qualityLevel, rds_rtChar *rtChar, uint8_t value, uint8_t weight);
+/* @brief Qty of characters at the beginning of RT which meet the quality level */
+static uint8_t rdsDecoder_rtStablePrefix(const rds_decoder *decoder);
+/* @brief Confirmations worth of a group, from error levels of its two data blocks. 0 if one is uncorrectable */
+static uint8_t rdsDecoder_blerWeight(uint8_t blerC, uint8_t blerD);
+/* @brief Add the two AF codes of block C (group 0A) to AF list */
+static void    rdsDecoder_processAF(rds_decoder *decoder, uint16_t blockC);
+/* @brief Add one AF code to AF list, if it is a frequency not yet known */
+static void    rdsDecoder_addAF(rds_decoder *decoder, uint8_t afCode);
 //static bool rdsDecoder_processPTY(uint8_t programmeType);
-static void    rdsDecoder_resetRT(void);
+static void    rdsDecoder_resetRT(rds_decoder *decoder);
 /* @brief Reset PS name from shadow registers */
-static void    rdsDecoder_resetPS(void);
+static void    rdsDecoder_resetPS(rds_decoder *decoder);
 
 
 /* _________________ RDS INIT FUNCTIONS _________________ */
 
 /* Init decoder */
-void rdsDecoder_init(RT_QUALITY_STATE wishedRTState, bool isVerbose)
+void rdsDecoder_init_r(rds_decoder *decoder, RT_QUALITY_STATE wishedRTState, bool isVerbose)
 {
-   printf("[FM][RDS] INIT RDS module\n");
    /* Cleanup memory */
-   rdsDecoder_reset();
-   rdsDecoder_resetPS();
-   rdsDecoder_resetRT();   /* Pretty useless if I do a memset my dear */
+   rdsDecoder_reset_r(decoder);
+   rdsDecoder_resetPS(decoder);
+   rdsDecoder_resetRT(decoder);   /* Pretty useless if I do a memset my dear */
    
-   _RDS_decoder._radioText_valid = false;
-   _RDS_decoder._verboseDecode   = isVerbose;
-   _RDS_decoder._qualityLevel    = wishedRTState;
+   rdsDecoder_resetStation_r(decoder);
+   decoder->_radioText_valid = false;
+   decoder->_verboseDecode   = isVerbose;
+   decoder->_qualityLevel    = wishedRTState;
 }
 
 /* Reset decoder */
-void rdsDecoder_reset(void)
+void rdsDecoder_reset_r(rds_decoder *decoder)
 {
    /* Everything set to 0 */
-   memset(&_RDS_decoder, 0, sizeof(rds_decoder));
+   memset(decoder, 0, sizeof(rds_decoder));
+}
+
+void rdsDecoder_resetStation_r(rds_decoder *decoder)
+{
+   rdsDecoder_resetPS(decoder);
+   rdsDecoder_resetRT(decoder);
+   decoder->_rt_abFlag        = 0x00;
+   decoder->_rt_abKnown       = false;
+   decoder->_programIdentifer = 0x0000;
+   decoder->_programType      = 0x00;
+   decoder->_trafficProgram   = 0x00;
+   decoder->_afCount          = 0x00;
+   decoder->_rtPlusGroup      = RDS_ODA_NONE;
+   memset(&decoder->_ptyName[0], 0x20, PTYN_MAX_CHARS);
+   memset(&decoder->_clockTime, 0, sizeof(rds_clockTime));
+   memset(&decoder->_rtPlusTags[0], 0, sizeof(decoder->_rtPlusTags));
+   memset(&decoder->_stats, 0, sizeof(rds_stats));
 }
 
 /* _________________ RDS DECODING FUNCTIONS _________________ */
-uint8_t rdsDecoder_processNewGroup(uint8_t* pointerToMsg, rds_groupBlocks *p_group)
+uint8_t rdsDecoder_processNewGroup_r(rds_decoder *decoder, uint8_t* pointerToMsg, const rds_groupBlocks *p_group)
 {
-   uint8_t retVal          = 0x00;
-   uint8_t rtFinished      = 0x00;
-   uint8_t unassignedBits  = 0x00;
-//   uint8_t programmeType   = 0x00;   /* Not implemented */
-   uint8_t groupType       = 0x00;
-   uint8_t trafficProgram  = 0x00;
+   uint8_t retVal    = 0x00;
+   uint8_t groupCode = 0x00;
+   rdsDecoder_groupHandler handler = NULL;
+   rds_stats *stats = &decoder->_stats;
+
+   stats->_groups++;
+   stats->_bler[0][p_group->bler_A & 0x03]++;
+   stats->_bler[1][p_group->bler_B & 0x03]++;
+   stats->_bler[2][p_group->bler_C & 0x03]++;
+   stats->_bler[3][p_group->bler_D & 0x03]++;
    
    /* ____________________________ process blocks ___________________________ */
-   /* ____ Block A: Program Identifier ____ */
-   _RDS_decoder._programIdentifer = p_group->block_A;
+   /* Group type and addresses are in block B, nothing can be done without it */
+   if(RDS_BLER_UNCORRECTABLE == p_group->bler_B)
+   {
+      stats->_discarded++;
+   }
+   else
+   {
+      /* ____ Block A: Program Identifier ____ */
+      if(RDS_BLER_UNCORRECTABLE != p_group->bler_A)
+      {
+         decoder->_programIdentifer = p_group->block_A;
+      }
    
-   /* ____ Block B:group type: ____ */
-   /* Get different info from block B: */
-   unassignedBits = (p_group->block_B & BLOCKB_UNASSIGNED_BITS_MASK) >> BLOCKB_UNASSIGNED_BITS_POS;
-   groupType      = (p_group->block_B & BLOCKB_GROUP_TYPE_MASK)      >> BLOCKB_GROUP_TYPE_POS;
-//   programmeType  = (p_group->block_B & BLOCKB_PROGRAM_TYPE_MASK)    >> BLOCKB_PROGRAM_TYPE_POS;
-   /* Process of version discarded, is not of use. Maybe in future */
-   trafficProgram = (p_group->block_B & BLOCKB_TRAFFIC_PROG_MASK)    >> BLOCKB_TRAFFIC_PROG_POS;
-
-   /* Process of RT and PS only if not Traffic Program */
-   if(0x00 == trafficProgram)
-   {
-      /* Process PS (program Service Name) */
-      if((GROUP_TYPE_0A == groupType) || (GROUP_TYPE_0B == groupType))
+      /* ____ Block B: common to all groups ____ */
+      decoder->_programType    = (p_group->block_B & BLOCKB_PROGRAM_TYPE_MASK) >> BLOCKB_PROGRAM_TYPE_POS;
+      decoder->_trafficProgram = (p_group->block_B & BLOCKB_TRAFFIC_PROG_MASK) >> BLOCKB_TRAFFIC_PROG_POS;
+
+      /* ____ Blocks C and D: depend on group type and version ____ */
+      groupCode = RDS_GROUP_CODE(p_group->block_B);
+      handler   = _groupHandlers[groupCode];
+      stats->_groupCodes[groupCode]++;
+      stats->_tpGroups += decoder->_trafficProgram;
+      if(NULL != handler)
+      {
+         retVal = handler(decoder, p_group, pointerToMsg);
+      }
+      else
       {
-         rdsDecoder_processPS(p_group->block_C, p_group->block_D, unassignedBits);
+         stats->_unhandled++;
       }
-      /* Process RT (Radio Text) */
-      else if((GROUP_TYPE_2A == groupType) || (GROUP_TYPE_2B == groupType))
+
+      if(0x00 != retVal)
+      {
+         stats->_lastRTGroup = stats->_groups;
+      }
+   }
+   return retVal;
+}
+
+uint16_t rdsDecoder_processGroups_r(rds_decoder *decoder, const rds_groupBlocks *groups, uint16_t groupCount, rds_batchResult *result)
+{
+   uint16_t index      = 0x0000;
+   uint16_t segments   = 0x0000;
+   uint8_t  segment    = 0x00;
+   uint8_t  rtSize     = 0x00;
+
+   result->_eventCount = 0x00;
+   while((index < groupCount) && (0x00 == rtSize)
+      && ((result->_eventCount + RDS_EVENTS_PER_GROUP) <= RDS_BATCH_MAX_EVENTS))
+   {
+      segments = decoder->_rt_segments;
+      rtSize   = rdsDecoder_processNewGroup_r(decoder, &result->_rt[0], &groups[index]);
+
+      if(true == decoder->_psEvent)
       {
-         rtFinished = rdsDecoder_processRT(p_group->block_C, p_group->block_D, unassignedBits);
+         decoder->_psEvent = false;
+         rdsDecoder_addEvent(result, index, RDS_EVENT_PS_CHANGED, 0x00);
+      }
 
-         /* If rtFinished > 0, RT decode finished, save it into pointerToMsg */
-         if(0 < rtFinished)
+      /* A group carries one segment: one new bit at most */
+      segments = decoder->_rt_segments & (uint16_t)~segments;
+      if(0x0000 != segments)
+      {
+         for(segment = 0; 0x0000 == (segments & (1U << segment)); segment++)
          {
-            rdsDecoder_getRTMessage(pointerToMsg, _RDS_decoder._qualityLevel, rtFinished);
-            retVal = rtFinished;
+            /* Search segment confirmed */
          }
+         rdsDecoder_addEvent(result, index, RDS_EVENT_RT_SEGMENT, segment);
+      }
+
+      if(0x00 != rtSize)
+      {
+         rdsDecoder_addEvent(result, index, RDS_EVENT_RT_COMPLETE, rtSize);
+      }
+      index++;
+   }
+   return index;
+}
+
+static void rdsDecoder_addEvent(rds_batchResult *result, uint16_t group, RDS_EVENT type, uint8_t value)
+{
+   result->_events[result->_eventCount]._group = group;
+   result->_events[result->_eventCount]._type  = (uint8_t)type;
+   result->_events[result->_eventCount]._value = value;
+   result->_eventCount++;
+}
+
+static uint8_t rdsDecoder_handle0A(rds_decoder *decoder, const rds_groupBlocks *group, uint8_t *pointerToMsg)
+{
+   /* AF are tuning information, block C of version A only */
+   if(RDS_BLER_UNCORRECTABLE != group->bler_C)
+   {
+      rdsDecoder_processAF(decoder, group->block_C);
+   }
+   return rdsDecoder_handle0B(decoder, group, pointerToMsg);
+}
+
+static uint8_t rdsDecoder_handle0B(rds_decoder *decoder, const rds_groupBlocks *group, uint8_t *pointerToMsg)
+{
+   (void)pointerToMsg;
+   /* Process PS (program Service Name) */
+   if(RDS_BLER_UNCORRECTABLE != group->bler_D)
+   {
+      rdsDecoder_processPS(decoder, group->block_D, (group->block_B & BLOCKB_UNASSIGNED_BITS_MASK) >> BLOCKB_UNASSIGNED_BITS_POS,
+                           rdsDecoder_blerWeight(group->bler_D, group->bler_D));
+   }
+   return 0x00;
+}
+
+static uint8_t rdsDecoder_handle2(rds_decoder *decoder, const rds_groupBlocks *group, uint8_t *pointerToMsg)
+{
+   uint8_t retVal     = 0x00;
+   uint8_t rtFinished = 0x00;
+   bool    versionB   = (0x00 != (group->block_B & BLOCKB_VERSION_MASK));
+   /* Version B: block C is PI, characters are in block D only */
+   uint8_t weight     = (true == versionB) ? rdsDecoder_blerWeight(group->bler_D, group->bler_D)
+                                           : rdsDecoder_blerWeight(group->bler_C, group->bler_D);
+
+   /* Process RT (Radio Text) */
+   if(0 < weight)
+   {
+      rtFinished = rdsDecoder_processRT(decoder, group->block_C, group->block_D,
+                                        (group->block_B & BLOCKB_UNASSIGNED_BITS_MASK) >> BLOCKB_UNASSIGNED_BITS_POS, weight, versionB);
+
+      /* If rtFinished > 0, RT decode finished, save it into pointerToMsg */
+      if(0 < rtFinished)
+      {
+         rdsDecoder_getRTMessage_r(decoder, pointerToMsg, decoder->_qualityLevel, rtFinished);
+         retVal = rtFinished;
       }
-      /* Here may be processed other kind of group type. Will be done in future */
    }
    return retVal;
 }
 
-static void rdsDecoder_processPS(uint16_t blockC, uint16_t blockD, uint8_t unassignedBits)
+static uint8_t rdsDecoder_handle3A(rds_decoder *decoder, const rds_groupBlocks *group, uint8_t *pointerToMsg)
 {
-   /* @TODO add mechanism to check PS name integrity. Right now, do it funny and print what we have on screen */
-   
-   /* 2 characters received per group. Multiply index per 2 */
-   uint8_t index = unassignedBits * PS_GROUP_NBR_CHARS;
-   /* Seems that in block C, data is only 0xE0CD - @TODO find info about what is in Block C */
-   _RDS_decoder._psName[index]         = (uint8_t)(blockD & 0xFF00) >> 8;
-   _RDS_decoder._psName[index + 0x01]  = (uint8_t)(blockD & 0x00FF);
+   (void)pointerToMsg;
+   /* Block B: group code carrying the application. Block D: application identifier */
+   if((RDS_BLER_UNCORRECTABLE != group->bler_D) && (RDS_AID_RTPLUS == group->block_D))
+   {
+      decoder->_rtPlusGroup = (uint8_t)(group->block_B & BLOCKB_UNASSIGNED_BITS_MASK);
+   }
+   return 0x00;
+}
 
-   if(0xE0CD != blockC)
+static uint8_t rdsDecoder_handle4A(rds_decoder *decoder, const rds_groupBlocks *group, uint8_t *pointerToMsg)
+{
+   (void)pointerToMsg;
+   /* MJD is on 17 bits: block B bits 1-0, block C bits 15-1. Hour on block C bit 0
+    * and block D bits 15-12, minute block D bits 11-6, offset sign bit 5 and value 4-0 */
+   if((RDS_BLER_UNCORRECTABLE != group->bler_C) && (RDS_BLER_UNCORRECTABLE != group->bler_D))
    {
-      printf("PS block C value: %02X\n", blockC);
+      decoder->_clockTime._mjd    = ((uint32_t)(group->block_B & 0x0003) << 15) | ((uint32_t)group->block_C >> 1);
+      decoder->_clockTime._hour   = (uint8_t)(((group->block_C & 0x0001) << 4) | ((group->block_D & 0xF000) >> 12));
+      decoder->_clockTime._minute = (uint8_t)((group->block_D & 0x0FC0) >> 6);
+      decoder->_clockTime._offset = (int8_t)(group->block_D & 0x001F);
+      if(0x00 != (group->block_D & 0x0020))
+      {
+         decoder->_clockTime._offset = -decoder->_clockTime._offset;
+      }
+      decoder->_clockTime._valid  = true;
    }
+   return 0x00;
 }
 
-static uint8_t rdsDecoder_processRT(uint16_t blockC, uint16_t blockD, uint8_t unassignedBits)
+static uint8_t rdsDecoder_handle10A(rds_decoder *decoder, const rds_groupBlocks *group, uint8_t *pointerToMsg)
 {
-   uint8_t sizeOfRTmessage = 0x00;
+   /* Segment address is block B bit 0, 4 characters per segment */
+   uint8_t index = (uint8_t)((group->block_B & 0x0001) * 4U);
+   (void)pointerToMsg;
 
-   /* 4 characters received per group. But we keep first 4 chars per 4. Assmbly will be at the end when message finished */
-   /* It is the index of RT message group. We receive RT group per RT group a 
-    * bunch of 4 chars, and an index. This index is only on four first bits. 
-    * 5th is for index cycle (if bit changed, one RT cycle is done) */
-   uint8_t rt_group_index        = (unassignedBits & 0x0F);
-   uint8_t rt_group_index_cycle  = (unassignedBits & 0x10) >> 4;
-   
-   uint8_t character_CA = (uint8_t)(blockC & 0xFF00) >> 8; /* 1st character */
-   uint8_t character_CB = (uint8_t)(blockC & 0x00FF);      /* 2nd character */
-   uint8_t character_DA = (uint8_t)(blockD & 0xFF00) >> 8; /* 3rd character */ 
-   uint8_t character_DB = (uint8_t)(blockD & 0x00FF);      /* 4th character */
-   
-   /* Prepare pointers to place where decoded ASCII characters must go */
-   uint8_t* pCharacter0 = &_RDS_decoder._rt_groups_rcvd[rt_group_index]._rt_group_chars[0];
-   uint8_t* pCharacter1 = &_RDS_decoder._rt_groups_rcvd[rt_group_index]._rt_group_chars[1];
-   uint8_t* pCharacter2 = &_RDS_decoder._rt_groups_rcvd[rt_group_index]._rt_group_chars[2];
-   uint8_t* pCharacter3 = &_RDS_decoder._rt_groups_rcvd[rt_group_index]._rt_group_chars[3];
+   if((RDS_BLER_UNCORRECTABLE != group->bler_C) && (RDS_BLER_UNCORRECTABLE != group->bler_D))
+   {
+      decoder->_ptyName[index]     = (uint8_t)((group->block_C & 0xFF00) >> 8);
+      decoder->_ptyName[index + 1] = (uint8_t)(group->block_C & 0x00FF);
+      decoder->_ptyName[index + 2] = (uint8_t)((group->block_D & 0xFF00) >> 8);
+      decoder->_ptyName[index + 3] = (uint8_t)(group->block_D & 0x00FF);
+   }
+   return 0x00;
+}
 
-   RT_QUALITY_STATE actualLineState = _RDS_decoder._rt_groups_rcvd[rt_group_index]._rt_group_state;
-   
-   /* No characters received at this line yet. Fill it */
-   if(RT_STATE_QUALITY_NONE == actualLineState)
-   {
-      *pCharacter0 = character_CA;
-      *pCharacter1 = character_CB;
-      *pCharacter2 = character_DA;
-      *pCharacter3 = character_DB;
-      
-      _RDS_decoder._rt_groups_rcvd[rt_group_index]._rt_group_state++; /* Increment quality */
-   }
-   /* Already received characters at this line, check if they are the same */
-   else if (actualLineState < _RDS_decoder._qualityLevel)
-   {
-      if( (*pCharacter0 == character_CA)
-       && (*pCharacter1 == character_CB)
-       && (*pCharacter2 == character_DA)
-       && (*pCharacter3 == character_DB))
+static uint8_t rdsDecoder_handleODA(rds_decoder *decoder, const rds_groupBlocks *group, uint8_t *pointerToMsg)
+{
+   (void)pointerToMsg;
+   /* RT+: content type 1 on block B bits 2-0 and block C bits 15-13, start C 12-7,
+    * length C 6-1. Content type 2 on block C bit 0 and block D 15-11, start D 10-5,
+    * length D 4-0 */
+   if((RDS_GROUP_CODE(group->block_B) == decoder->_rtPlusGroup)
+   && (RDS_BLER_UNCORRECTABLE != group->bler_C) && (RDS_BLER_UNCORRECTABLE != group->bler_D))
+   {
+      decoder->_rtPlusTags[0]._contentType = (uint8_t)(((group->block_B & 0x0007) << 3) | ((group->block_C & 0xE000) >> 13));
+      decoder->_rtPlusTags[0]._start       = (uint8_t)((group->block_C & 0x1F80) >> 7);
+      decoder->_rtPlusTags[0]._length      = (uint8_t)((group->block_C & 0x007E) >> 1);
+      decoder->_rtPlusTags[1]._contentType = (uint8_t)(((group->block_C & 0x0001) << 5) | ((group->block_D & 0xF800) >> 11));
+      decoder->_rtPlusTags[1]._start       = (uint8_t)((group->block_D & 0x07E0) >> 5);
+      decoder->_rtPlusTags[1]._length      = (uint8_t)(group->block_D & 0x001F);
+   }
+   return 0x00;
+}
+
+static void rdsDecoder_processPS(rds_decoder *decoder, uint16_t blockD, uint8_t unassignedBits, uint8_t weight)
+{
+   /* 2 characters received per group. Multiply index per 2. Only 2 lower bits 
+    * are the segment address, others are TA, M/S and DI flags */
+   uint8_t segment   = unassignedBits & (PS_GROUP_MAX_INDEX - 1);
+   uint8_t index     = segment * PS_GROUP_NBR_CHARS;
+   uint8_t charIndex = 0x00;
+   bool    changed   = false;
+
+   changed |= rdsDecoder_votePSChar(&decoder->_psChars[index],        (uint8_t)((blockD & 0xFF00) >> 8), weight);
+   changed |= rdsDecoder_votePSChar(&decoder->_psChars[index + 0x01], (uint8_t)(blockD & 0x00FF),        weight);
+
+   /* A character changed: PS is moving, every segment must be confirmed again */
+   if(true == changed)
+   {
+      decoder->_psSegments = 0x00;
+   }
+
+   if((PS_CONFIRM_VOTES <= decoder->_psChars[index]._votes)
+   && (PS_CONFIRM_VOTES <= decoder->_psChars[index + 0x01]._votes))
+   {
+      decoder->_psSegments |= (uint8_t)(1 << segment);
+   }
+
+   /* All segments confirmed: stable PS. Notify it only if it is a new one */
+   if(PS_SEGMENTS_ALL == decoder->_psSegments)
+   {
+      for(charIndex = 0; (charIndex < PS_GROUP_MAX_CHARS) && (decoder->_psChars[charIndex]._value == decoder->_psName[charIndex]); charIndex++)
+      {
+         /* Search first character which differs from last stable PS */
+      }
+
+      if((PS_GROUP_MAX_CHARS != charIndex) || (0x00 == decoder->_psChanges))
       {
-         _RDS_decoder._rt_groups_rcvd[rt_group_index]._rt_group_state++; /* Increment quality */
+         for(charIndex = 0; charIndex < PS_GROUP_MAX_CHARS; charIndex++)
+         {
+            decoder->_psName[charIndex] = decoder->_psChars[charIndex]._value;
+         }
+         decoder->_psEvent = true;
+         decoder->_psChanges++;
+         decoder->_stats._lastPSGroup = decoder->_stats._groups;
+         if(PS_DYNAMIC_CHANGES < decoder->_psChanges)
+         {
+            decoder->_psDynamic = true;
+         }
+      }
+   }
+}
+
+static bool rdsDecoder_votePSChar(rds_psChar *psChar, uint8_t value, uint8_t weight)
+{
+   bool retVal = false;
+
+   if(value == psChar->_value)
+   {
+      psChar->_votes = ((psChar->_votes + weight) < PS_VOTES_MAX) ? (uint8_t)(psChar->_votes + weight) : PS_VOTES_MAX;
+      /* Challenger was most probably an error */
+      psChar->_challengerVotes = 0x00;
+   }
+   else if(0x00 == psChar->_votes)
+   {
+      psChar->_value = value;
+      psChar->_votes = weight;
+   }
+   else
+   {
+      if(value == psChar->_challenger)
+      {
+         psChar->_challengerVotes += weight;
       }
       else
       {
-         /* @TODO it may be a new message. If we are in state 
-         AUTOCORRECTING from Si470x, then reset message, otherwise, just discard this element */
-         
-         /* Save new RT data */
-         *pCharacter0 = character_CA;
-         *pCharacter1 = character_CB;
-         *pCharacter2 = character_DA;
-         *pCharacter3 = character_DB;
-         
-         _RDS_decoder._rt_groups_rcvd[rt_group_index]._rt_group_state++; /* Increment quality */
+         psChar->_challenger      = value;
+         psChar->_challengerVotes = weight;
+      }
+
+      /* Challenger confirmed: character really changed */
+      if(PS_CONFIRM_VOTES <= psChar->_challengerVotes)
+      {
+         retVal = (PS_CONFIRM_VOTES <= psChar->_votes);
+         psChar->_value           = psChar->_challenger;
+         psChar->_votes           = psChar->_challengerVotes;
+         psChar->_challengerVotes = 0x00;
       }
    }
-   /* Else, quality level already reached for this line (group) */
+   return retVal;
+}
+
+static void rdsDecoder_processAF(rds_decoder *decoder, uint16_t blockC)
+{
+   /* Method A: first code of list is a count (224 + N), frequencies follow
+    * two by two. Count and filler codes carry no frequency, simply skip them */
+   rdsDecoder_addAF(decoder, (uint8_t)((blockC & 0xFF00) >> 8));
+   rdsDecoder_addAF(decoder, (uint8_t)(blockC & 0x00FF));
+}
 
-   /* RT complete only if 5th bit of blockB->unassigned_bits changes its state */
-   if(rt_group_index_cycle != _RDS_decoder._rt_index_cycle)
+static void rdsDecoder_addAF(rds_decoder *decoder, uint8_t afCode)
+{
+   uint8_t index = 0x00;
+
+   /* LF/MF codes (after code 250) are ignored, as Si470x is FM only */
+   if((AF_CODE_FREQ_MIN <= afCode) && (AF_CODE_FREQ_MAX >= afCode))
    {
-      /* Save actual index cycle state */
-      _RDS_decoder._rt_index_cycle = rt_group_index_cycle;
-      
-      /* Check that all received RT group quality meet required quality level */
-      uint8_t index = 0;
-      while (_RDS_decoder._rt_groups_rcvd[index]._rt_group_state >= _RDS_decoder._qualityLevel) {
+      /* Lists are sent again and again, keep each frequency once */
+      while((index < decoder->_afCount) && (afCode != decoder->_afList[index]))
+      {
          index++;
       }
-      
-      if(index == RT_GROUP_MAX_INDEX)
+
+      if((index == decoder->_afCount) && (AF_MAX_FREQS > decoder->_afCount))
+      {
+         decoder->_afList[decoder->_afCount] = afCode;
+         decoder->_afCount++;
+      }
+   }
+}
+
+static uint8_t rdsDecoder_blerWeight(uint8_t blerC, uint8_t blerD)
+{
+   uint8_t worst  = (blerC > blerD) ? blerC : blerD;
+   uint8_t retVal = RDS_BLER_WEIGHT_CORRECTED;
+
+   if(RDS_BLER_NONE == worst)
+   {
+      retVal = RDS_BLER_WEIGHT_NONE;
+   }
+   else if(RDS_BLER_UNCORRECTABLE <= worst)
+   {
+      retVal = 0x00;
+   }
+   return retVal;
+}
+
+static uint8_t rdsDecoder_processRT(rds_decoder *decoder, uint16_t blockC, uint16_t blockD, uint8_t unassignedBits, uint8_t weight, bool versionB)
+{
+   uint8_t sizeOfRTmessage = 0x00;
+   uint8_t characters[RT_GROUP_NBR_CHARS];
+   uint8_t nbrChars  = RT_GROUP_NBR_CHARS;
+   uint8_t charIndex = 0x00;
+   uint8_t position  = 0x00;
+   rds_rtChar *rtChar;
+
+   /* It is the index of RT message group. We receive RT group per RT group a 
+    * bunch of 4 chars (2 in version B), and an index. This index is only on four
+    * first bits. 5th is text A/B flag: it toggles when a new text is on air */
+   uint8_t rt_group_index = (unassignedBits & 0x0F);
+   uint8_t rt_abFlag      = (unassignedBits & 0x10) >> 4;
+
+   /* New text: never mix it with characters of previous one */
+   if((true == decoder->_rt_abKnown) && (rt_abFlag != decoder->_rt_abFlag))
+   {
+      rdsDecoder_resetRT(decoder);
+   }
+   decoder->_rt_abFlag  = rt_abFlag;
+   decoder->_rt_abKnown = true;
+
+   if(true == versionB)
+   {
+      nbrChars      = RT_GROUP_B_NBR_CHARS;
+      characters[0] = (uint8_t)((blockD & 0xFF00) >> 8);
+      characters[1] = (uint8_t)(blockD & 0x00FF);
+      if(RT_GROUP_B_MAX_CHARS < decoder->_rt_size)
+      {
+         decoder->_rt_size = RT_GROUP_B_MAX_CHARS;
+      }
+   }
+   else
+   {
+      characters[0] = (uint8_t)((blockC & 0xFF00) >> 8);
+      characters[1] = (uint8_t)(blockC & 0x00FF);
+      characters[2] = (uint8_t)((blockD & 0xFF00) >> 8);
+      characters[3] = (uint8_t)(blockD & 0x00FF);
+   }
+
+   for(charIndex = 0; charIndex < nbrChars; charIndex++)
+   {
+      position = (rt_group_index * nbrChars) + charIndex;
+      rtChar   = &decoder->_rt_chars[position];
+      rdsDecoder_voteRTChar(decoder->_qualityLevel, rtChar, characters[charIndex], weight);
+
+      /* Confirmed end of text: message is shorter than maximum */
+      if((RT_END_OF_TEXT == rtChar->_rt_char) && (rtChar->_rt_char_state >= decoder->_qualityLevel)
+      && (position < decoder->_rt_size))
       {
-         /* Radio Text message complete, return size of RT message in multiple of 4 */
-         /* When bit 5 changes, we reached maximum index of RT message */
-         sizeOfRTmessage = rt_group_index;
+         decoder->_rt_size = position;
       }
    }
 
+   rdsDecoder_confirmRTSegment(decoder, rt_group_index, nbrChars);
+
+   /* Complete once every character up to end of text meets quality level. Returned once */
+   if((false == decoder->_rt_complete) && (rdsDecoder_rtStablePrefix(decoder) == decoder->_rt_size))
+   {
+      decoder->_rt_complete = true;
+      sizeOfRTmessage = decoder->_rt_size;
+   }
+
    return sizeOfRTmessage;
 }
 
-void rdsDecoder_getRTMessage(uint8_t* pointerToMsg, RT_QUALITY_STATE wishedRTState, uint8_t msgSize)
+static void rdsDecoder_confirmRTSegment(rds_decoder *decoder, uint8_t segment, uint8_t nbrChars)
+{
+   uint8_t charIndex = 0x00;
+   uint8_t position  = segment * nbrChars;
+
+   while((charIndex < nbrChars) && (decoder->_rt_chars[position + charIndex]._rt_char_state >= decoder->_qualityLevel))
+   {
+      charIndex++;
+   }
+
+   if(charIndex == nbrChars)
+   {
+      decoder->_rt_segments |= (uint16_t)(1U << segment);
+   }
+}
+
+static void rdsDecoder_voteRTChar(RT_QUALITY_STATE qualityLevel, rds_rtChar *rtChar, uint8_t value, uint8_t weight)
 {
-   uint8_t indexLines = 0U;
-   uint8_t charStringIndex = 0U;
+   RT_QUALITY_STATE actualState = rtChar->_rt_char_state;
+   uint8_t newState = (uint8_t)actualState + weight;
+
+   /* An error free group is worth two confirmations */
+   if(RT_STATE_QUALITY_GOOD < newState)
+   {
+      newState = RT_STATE_QUALITY_GOOD;
+   }
+
+   /* No character received at this place yet */
+   if(RT_STATE_QUALITY_NONE == actualState)
+   {
+      rtChar->_rt_char       = value;
+      rtChar->_rt_char_state = (RT_QUALITY_STATE)weight;
+   }
+   /* Already received, check if it is the same */
+   else if(actualState < qualityLevel)
+   {
+      if(rtChar->_rt_char == value)
+      {
+         rtChar->_rt_char_state = (RT_QUALITY_STATE)newState;
+      }
+      /* Characters differ: keep the one received with less errors, count again from there */
+      else if(weight >= actualState)
+      {
+         rtChar->_rt_char       = value;
+         rtChar->_rt_char_state = (RT_QUALITY_STATE)weight;
+      }
+      /* Else, corrected character against a better confirmed one: discard it */
+   }
+   /* Else, quality level already reached for this character */
+}
+
+static uint8_t rdsDecoder_rtStablePrefix(const rds_decoder *decoder)
+{
+   uint8_t index = 0x00;
+
+   while((index < decoder->_rt_size) && (RT_STATE_QUALITY_NONE != decoder->_rt_chars[index]._rt_char_state)
+      && (decoder->_rt_chars[index]._rt_char_state >= decoder->_qualityLevel))
+   {
+      index++;
+   }
+   return index;
+}
+
+void rdsDecoder_getRTMessage_r(const rds_decoder *decoder, uint8_t* pointerToMsg, RT_QUALITY_STATE wishedRTState, uint8_t msgSize)
+{
+   uint8_t index = 0U;
    
-   for (;indexLines < msgSize; indexLines++)
+   for (;(index < msgSize) && (index < RT_GROUP_MAX_CHARS); index++)
    {
-      if(_RDS_decoder._rt_groups_rcvd[indexLines]._rt_group_state >= wishedRTState)
+      if(decoder->_rt_chars[index]._rt_char_state >= wishedRTState)
       {
-         /* 4 characters per line, move 4 per 4 */
-         charStringIndex = indexLines * RT_GROUP_NBR_CHARS;
-         *(pointerToMsg + (charStringIndex))     = _RDS_decoder._rt_groups_rcvd[indexLines]._rt_group_chars[0];
-         *(pointerToMsg + (charStringIndex + 1)) = _RDS_decoder._rt_groups_rcvd[indexLines]._rt_group_chars[1];
-         *(pointerToMsg + (charStringIndex + 2)) = _RDS_decoder._rt_groups_rcvd[indexLines]._rt_group_chars[2];
-         *(pointerToMsg + (charStringIndex + 3)) = _RDS_decoder._rt_groups_rcvd[indexLines]._rt_group_chars[3];
+         *(pointerToMsg + index) = decoder->_rt_chars[index]._rt_char;
       }
       else /* Fill with blank */
       {
-         *(pointerToMsg + (charStringIndex))     = 0x20; /* Fill with SPACE ASCII character */
-         *(pointerToMsg + (charStringIndex + 1)) = 0x20; /* Fill with SPACE ASCII character */
-         *(pointerToMsg + (charStringIndex + 2)) = 0x20; /* Fill with SPACE ASCII character */
-         *(pointerToMsg + (charStringIndex + 3)) = 0x20; /* Fill with SPACE ASCII character */
+         *(pointerToMsg + index) = 0x20; /* Fill with SPACE ASCII character */
       }
    }
 }
 
-static void rdsDecoder_resetRT(void)
+uint8_t rdsDecoder_getRTPrefix_r(rds_decoder *decoder, uint8_t* pointerToMsg)
 {
-   uint8_t indexLines = 0U;
+   uint8_t prefix = rdsDecoder_rtStablePrefix(decoder);
+   uint8_t end    = prefix;
+   uint8_t retVal = 0x00;
+
+   /* Cut after last full word, next characters are not known yet */
+   if(prefix < decoder->_rt_size)
+   {
+      while((0 < end) && (0x20 != decoder->_rt_chars[end - 1]._rt_char))
+      {
+         end--;
+      }
+   }
+
+   if((false == decoder->_rt_complete) && (end >= (decoder->_rt_published + RT_PREFIX_MIN_GROWTH)))
+   {
+      rdsDecoder_getRTMessage_r(decoder, pointerToMsg, decoder->_qualityLevel, end);
+      decoder->_rt_published = end;
+      retVal = end;
+   }
+   return retVal;
+}
+
+static void rdsDecoder_resetRT(rds_decoder *decoder)
+{
+   uint8_t index = 0U;
    /* Reset only RT messages */
-   for (;indexLines < RT_GROUP_MAX_INDEX; indexLines++)
+   for (;index < RT_GROUP_MAX_CHARS; index++)
    {
-      _RDS_decoder._rt_groups_rcvd[indexLines]._rt_group_chars[0] = 0x00;
-      _RDS_decoder._rt_groups_rcvd[indexLines]._rt_group_chars[1] = 0x00;
-      _RDS_decoder._rt_groups_rcvd[indexLines]._rt_group_chars[2] = 0x00;
-      _RDS_decoder._rt_groups_rcvd[indexLines]._rt_group_chars[3] = 0x00;
-      _RDS_decoder._rt_groups_rcvd[indexLines]._rt_group_state = RT_STATE_QUALITY_NONE;
+      decoder->_rt_chars[index]._rt_char       = 0x00;
+      decoder->_rt_chars[index]._rt_char_state = RT_STATE_QUALITY_NONE;
    }
-   _RDS_decoder._rt_index_cycle = 0x00;
+   decoder->_rt_size      = RT_GROUP_MAX_CHARS;
+   decoder->_rt_published = 0x00;
+   decoder->_rt_complete  = false;
+   decoder->_rt_segments  = 0x0000;
    
    /* Do not use memset(), as it resets all bytes of memory with the size of argument
     * Siez of an enumerate is unknown
     */
 }
 
-static void rdsDecoder_resetPS(void)
+static void rdsDecoder_resetPS(rds_decoder *decoder)
 {
    uint8_t index = 0;
    for(;index < PS_GROUP_MAX_CHARS; index++)
    {
-      _RDS_decoder._psName[index] = 0x20; /* Fill with space character */
+      decoder->_psName[index] = 0x20; /* Fill with space character */
    }
+   memset(&decoder->_psChars[0], 0, sizeof(decoder->_psChars));
+   decoder->_psSegments = 0x00;
+   decoder->_psChanges  = 0x00;
+   decoder->_psEvent    = false;
+   decoder->_psDynamic  = false;
+}
+
+bool rdsDecoder_getPS_r(const rds_decoder *decoder, uint8_t* buffPS)
+{
+   memcpy(buffPS, &decoder->_psName[0], PS_GROUP_MAX_CHARS);
+   return (PS_SEGMENTS_ALL == decoder->_psSegments);
+}
+
+bool rdsDecoder_getPSEvent_r(rds_decoder *decoder)
+{
+   bool retVal = decoder->_psEvent;
+   decoder->_psEvent = false;
+   return retVal;
+}
+
+bool rdsDecoder_isPSDynamic_r(const rds_decoder *decoder)
+{
+   return decoder->_psDynamic;
+}
+
+uint8_t rdsDecoder_getAF_r(const rds_decoder *decoder, uint8_t* afList)
+{
+   memcpy(afList, &decoder->_afList[0], decoder->_afCount);
+   return decoder->_afCount;
+}
+
+uint16_t rdsDecoder_getPI_r(const rds_decoder *decoder)
+{
+   return decoder->_programIdentifer;
+}
+
+uint8_t rdsDecoder_getPTY_r(const rds_decoder *decoder)
+{
+   return decoder->_programType;
+}
+
+void rdsDecoder_getPTYN_r(const rds_decoder *decoder, uint8_t* buffPTYN)
+{
+   memcpy(buffPTYN, &decoder->_ptyName[0], PTYN_MAX_CHARS);
+}
+
+bool rdsDecoder_getCT_r(const rds_decoder *decoder, rds_clockTime* clockTime)
+{
+   *clockTime = decoder->_clockTime;
+   return decoder->_clockTime._valid;
+}
+
+bool rdsDecoder_getRTPlus_r(const rds_decoder *decoder, rds_rtPlusTag* tags)
+{
+   memcpy(tags, &decoder->_rtPlusTags[0], sizeof(decoder->_rtPlusTags));
+   return ((RDS_ODA_NONE != decoder->_rtPlusGroup) && (0 != decoder->_rtPlusTags[0]._contentType));
+}
+
+void rdsDecoder_getStats_r(const rds_decoder *decoder, rds_stats* stats)
+{
+   *stats = decoder->_stats;
+}
+
+/* _________________ DEFAULT INSTANCE _________________ */
+
+void rdsDecoder_init(RT_QUALITY_STATE wishedRTState, bool isVerbose)
+{
+   printf("[FM][RDS] INIT RDS module\n");
+   rdsDecoder_init_r(&_RDS_decoder, wishedRTState, isVerbose);
+}
+
+void rdsDecoder_reset(void)
+{
+   rdsDecoder_reset_r(&_RDS_decoder);
+}
+
+void rdsDecoder_resetStation(void)
+{
+   rdsDecoder_resetStation_r(&_RDS_decoder);
+}
+
+uint8_t rdsDecoder_processNewGroup(uint8_t* pointerToMsg, rds_groupBlocks *p_group)
+{
+   return rdsDecoder_processNewGroup_r(&_RDS_decoder, pointerToMsg, p_group);
+}
+
+uint16_t rdsDecoder_processGroups(const rds_groupBlocks *groups, uint16_t groupCount, rds_batchResult *result)
+{
+   return rdsDecoder_processGroups_r(&_RDS_decoder, groups, groupCount, result);
+}
+
+void rdsDecoder_getRTMessage(uint8_t* pointerToMsg, RT_QUALITY_STATE wishedRTState, uint8_t msgSize)
+{
+   rdsDecoder_getRTMessage_r(&_RDS_decoder, pointerToMsg, wishedRTState, msgSize);
+}
+
+uint8_t rdsDecoder_getRTPrefix(uint8_t* pointerToMsg)
+{
+   return rdsDecoder_getRTPrefix_r(&_RDS_decoder, pointerToMsg);
 }
 
 bool rdsDecoder_getPS(uint8_t* buffPS)
 {
-   /* Send back pointer to frist character of string */
-   buffPS = &_RDS_decoder._psName[0];
+   return rdsDecoder_getPS_r(&_RDS_decoder, buffPS);
+}
 
-   printf("Got: %c", *buffPS);
+bool rdsDecoder_getPSEvent(void)
+{
+   return rdsDecoder_getPSEvent_r(&_RDS_decoder);
+}
+
+bool rdsDecoder_isPSDynamic(void)
+{
+   return rdsDecoder_isPSDynamic_r(&_RDS_decoder);
+}
+
+uint8_t rdsDecoder_getAF(uint8_t* afList)
+{
+   return rdsDecoder_getAF_r(&_RDS_decoder, afList);
+}
 
-   /* @TODO adapt if PS parsing not yet finished */
-   return true;
-}
\ No newline at end of file
+uint16_t rdsDecoder_getPI(void)
+{
+   return rdsDecoder_getPI_r(&_RDS_decoder);
+}
+
+uint8_t rdsDecoder_getPTY(void)
+{
+   return rdsDecoder_getPTY_r(&_RDS_decoder);
+}
+
+void rdsDecoder_getPTYN(uint8_t* buffPTYN)
+{
+   rdsDecoder_getPTYN_r(&_RDS_decoder, buffPTYN);
+}
+
+bool rdsDecoder_getCT(rds_clockTime* clockTime)
+{
+   return rdsDecoder_getCT_r(&_RDS_decoder, clockTime);
+}
+
+bool rdsDecoder_getRTPlus(rds_rtPlusTag* tags)
+{
+   return rdsDecoder_getRTPlus_r(&_RDS_decoder, tags);
+}
+
+void rdsDecoder_getStats(rds_stats* stats)
+{
+   rdsDecoder_getStats_r(&_RDS_decoder, stats);
+}
@@ -59,21 +59,25 @@ extern "C" {
  * SUPPORTED FEATURES:
  * - RT (Radio Text)
  * - PS (Program Service Name)
+ * - AF (alternative frequencies), method A lists of group 0A
+ * - PTY (programme type, all groups) and PTYN (programme type name, group 10A)
+ * - CT (clock time and date, group 4A)
+ * - ODA (open data applications, group 3A): RT+ (radio text plus) tags
+ * 
+ * Groups are dispatched through a table indexed by group type and version
+ * (RDS_GROUP_CODE). A group without handler costs one table lookup. To support
+ * a new group, write its handler and register it in _groupHandlers.
  * 
  * ______________________________________
  * UNSUPPORTED FEATURES:
  * - EON (enhanced other networks information) -> Switch to next radio with good quality is more important than exclusively listening to one type of stuff
  * - PI (programme identification) -> like it is important to see stuff like PI=C201 (which means BBC Radio)...
- * - PTY (programme type) -> it is not because we have a program type, that we like the content...
- * - TA, TP (traffic announcement, traffic programme) -> If you are stuck in traffic jam, try biking or train
+ * - TA (traffic announcement) -> If you are stuck in traffic jam, try biking or train. TP stations are decoded as any other one
  * - TMC (traffic message channel) -> It is soooo 1990-2000. Now we use other mean which are way much better and makes this thing obsolete
  * 
  * ______________________________________
  * FUTURE DEVELOPMENTS:
- * - AF (alternative frequencies)
- * - CT (clock time and date)
- * - RT+ (radio text plus)
- * - RT messages errors correction
+ * - RT messages errors correction (block error levels are used to weight and reject blocks)
  * 
  * ______________________________________
  * Example of RDS/RBDS recevied blocks and their meaning:
@@ -89,28 +93,70 @@ extern "C" {
  */
 
 /**
- * Types of group that are interessant for us:
+ * Types of group that are interessant for us. Value is the group code: group
+ * type and version bits of block B, see RDS_GROUP_CODE()
  * Type:   A3 A2 A1 A0 B0 (Bits)
  * 0A      0  0  0  0  0  Basic Tuning and Switching Information only
  * 0B      0  0  0  0  1  Basic Tuning and Switching Information only
  * 2A      0  0  1  0  0  Radio Text only
  * 2B      0  0  1  0  1  Radio Text only
+ * 3A      0  0  1  1  0  Open data application identification
+ * 4A      0  1  0  0  0  Clock time and date
+ * 10A     1  0  1  0  0  Programme type name
+ * 11A     1  0  1  1  0  Open data application (RT+ most of the time)
  * 
  */
 typedef enum {
-   GROUP_TYPE_0A = 0x00, /* PS (program Name) */
-   GROUP_TYPE_0B = 0x01, /* PS (program Name) */
-   GROUP_TYPE_2A = 0x04, /* Radio Text only */
-   GROUP_TYPE_2B = 0x05  /* Radio Text only */
+   GROUP_TYPE_0A  = 0x00, /* PS (program Name) */
+   GROUP_TYPE_0B  = 0x01, /* PS (program Name) */
+   GROUP_TYPE_2A  = 0x04, /* Radio Text only */
+   GROUP_TYPE_2B  = 0x05, /* Radio Text only */
+   GROUP_TYPE_3A  = 0x06, /* ODA identification */
+   GROUP_TYPE_4A  = 0x08, /* CT (clock time) */
+   GROUP_TYPE_10A = 0x14, /* PTYN (programme type name) */
+   GROUP_TYPE_11A = 0x16  /* ODA */
 } GROUP_TYPE;
 
+#define RDS_GROUP_CODES   32U   /* 16 group types, 2 versions */
+/* Group code (GROUP_TYPE) of a block B */
+#define RDS_GROUP_CODE(blockB)   ((uint8_t)(((blockB) & (BLOCKB_GROUP_TYPE_MASK | BLOCKB_VERSION_MASK)) >> BLOCKB_VERSION_POS))
+
 #define RT_GROUP_NBR_CHARS 4U  /* 4 characters are sent in one RT group */
 #define RT_GROUP_MAX_INDEX 16U /* 4 characters * 16 = 64 characters. Maximum qty of characters allowed in RT free msg */
 #define RT_GROUP_MAX_CHARS 64U /* 64 characters. Maximum qty of characters allowed in RT free msg */
+#define RT_GROUP_B_NBR_CHARS 2U /* Version B: 2 characters per group, block C carries PI */
+#define RT_GROUP_B_MAX_CHARS 32U
+#define RT_END_OF_TEXT     0x0D /* Carriage return ends an RT shorter than 64 characters */
+#define RT_PREFIX_MIN_GROWTH 8U /* Stable RT prefix is published again once grown by that much, at a word end */
 #define PS_GROUP_MAX_CHARS 8U
 #define PS_GROUP_NBR_CHARS 2U  /* 2 characters are sent in one RT group */
+#define PS_GROUP_MAX_INDEX 4U  /* 2 characters * 4 = 8 characters of PS name */
+#define PS_SEGMENTS_ALL    0x0F /* One bit per received PS segment */
+#define PS_CONFIRM_VOTES   2U   /* Votes to confirm a PS character: one error free group, or two corrected ones */
+#define PS_VOTES_MAX       6U   /* Saturation of votes of a PS character */
+#define PS_DYNAMIC_CHANGES 2U   /* Stable PS changed more than that since station change: dynamic (scrolling) PS */
 
 #define PTY_NUMBER         0x1F
+#define PTYN_MAX_CHARS     8U     /* PTYN, 2 segments of 4 characters */
+
+/* ODA (open data applications) identifiers, group 3A block D */
+#define RDS_AID_RTPLUS     0x4BD7
+#define RDS_ODA_NONE       0xFF   /* No group code registered for an ODA */
+
+/* RT+ content types (IEC 62106-6), the most useful ones */
+#define RTPLUS_ITEM_TITLE  1U
+#define RTPLUS_ITEM_ALBUM  2U
+#define RTPLUS_ITEM_ARTIST 4U
+#define RTPLUS_TAGS        2U     /* Two tags per RT+ group */
+
+/* AF (alternative frequencies) codes, two per block C of group 0A. See IEC 62106 */
+#define AF_MAX_FREQS       25U    /* Maximum qty of AF of one station */
+#define AF_CODE_FREQ_MIN   1U     /* 87.6 MHz */
+#define AF_CODE_FREQ_MAX   204U   /* 107.9 MHz */
+#define AF_CODE_FILLER     205U   /* No frequency, fills an odd list */
+#define AF_CODE_COUNT_MIN  224U   /* 224 + N: N frequencies follow */
+#define AF_CODE_COUNT_MAX  249U
+#define AF_CODE_TO_MHZ(code)  (87.5f + ((float)(code) * 0.1f))
 
 /* Block B masks - RDS specific masking */
 #define BLOCKB_GROUP_TYPE_MASK      0xF000
@@ -120,9 +166,12 @@ typedef enum {
 #define BLOCKB_TRAFFIC_PROG_MASK    0x0400
 #define BLOCKB_TRAFFIC_PROG_POS     10U
 #define BLOCKB_PROGRAM_TYPE_MASK    0x03E0
-#define BLOCKB_PROGRAM_TYPE_POS     6U
+#define BLOCKB_PROGRAM_TYPE_POS     5U
 #define BLOCKB_UNASSIGNED_BITS_MASK 0x001F   /* Are the index of text in case of group_type = RT */
 #define BLOCKB_UNASSIGNED_BITS_POS  0U
+#define BLOCKB_RT_AB_FLAG_MASK      0x0010   /* Group type 2: toggles when a new RT is broadcasted */
+#define BLOCKB_RT_AB_FLAG_POS       4U
+#define GROUP_TYPE_RT               2U       /* Group type (without version) of RT */
 
 typedef enum {
    RT_STATE_QUALITY_NONE = 0x00,
@@ -131,41 +180,138 @@ typedef enum {
    RT_STATE_QUALITY_GOOD
 } RT_QUALITY_STATE;
 
-/* For each group of RT received (group types 2A or 2B), 
- * describe state of those 4 characters. Allow us to say if we confirmed the 
- * redundancy of 4 characters received (same index, same value) and if we have a
- * full message (index cycle detected)
+/* For each character of RT received (group types 2A or 2B), describe its
+ * state. Allow us to say if we confirmed the redundancy of a character received
+ * (same index, same value) and if we have a full message or a stable beginning
+ * of message. Version A sends 4 characters per group, version B only 2.
  */
 typedef struct {
-   RT_QUALITY_STATE _rt_group_state;
-   uint8_t  _rt_group_chars[RT_GROUP_NBR_CHARS];   /* 4 characters per RT group */
-} rds_rtGroup;
+   RT_QUALITY_STATE _rt_char_state;
+   uint8_t          _rt_char;
+} rds_rtChar;
+
+/* CT (clock time and date) of group 4A. UTC time, local offset apart */
+typedef struct {
+   uint32_t _mjd;          /* Modified Julian Day */
+   uint8_t  _hour;         /* UTC hour */
+   uint8_t  _minute;       /* UTC minute */
+   int8_t   _offset;       /* Local time offset, in half hours */
+   bool     _valid;        /* At least one CT group received */
+} rds_clockTime;
+
+/* One RT+ tag: a part of RT message with a meaning (title, artist...) */
+typedef struct {
+   uint8_t _contentType;   /* RTPLUS_ITEM_xxx, 0 if none */
+   uint8_t _start;         /* Index of first character in RT */
+   uint8_t _length;        /* Qty of characters, minus one */
+} rds_rtPlusTag;
+
+/* Vote of one PS character. A different character must collect PS_CONFIRM_VOTES
+ * before replacing the voted one, so that a single wrong block changes nothing */
+typedef struct {
+   uint8_t _value;            /* Character voted */
+   uint8_t _votes;            /* Votes of _value, weighted by block errors */
+   uint8_t _challenger;       /* Last different character received */
+   uint8_t _challengerVotes;  /* Votes of _challenger */
+} rds_psChar;
 
 typedef struct {
    uint8_t _ptyID;
    char _ptyName[20];   /* @WARNING, change/remove magic number*/
 } rds_ptyConverter;
 
+#define RDS_BLOCKS         4U     /* Blocks A to D */
+#define RDS_BLER_LEVELS    4U     /* RDS_BLER values */
+
+/* Reception statistics of actual station, reset with it. Time is not known by
+ * decoder: it counts groups, 87.6 ms each on air */
+typedef struct {
+   uint32_t _groups;                           /* Groups given to decoder */
+   uint32_t _groupCodes[RDS_GROUP_CODES];      /* Groups per type and version (RDS_GROUP_CODE), block B usable */
+   uint32_t _bler[RDS_BLOCKS][RDS_BLER_LEVELS];/* Blocks A to D, per RDS_BLER */
+   uint32_t _discarded;                        /* Block B uncorrectable: group type unknown, nothing decoded */
+   uint32_t _unhandled;                        /* Group codes without handler (TMC, EON...): only PI/PTY/TP used */
+   uint32_t _tpGroups;                         /* Groups with TP (traffic programme) flag */
+   uint32_t _lastPSGroup;                      /* _groups when last stable PS name changed, 0 if never */
+   uint32_t _lastRTGroup;                      /* _groups when last RT message completed, 0 if never */
+} rds_stats;
+
 typedef struct {
    /* All RT group received, maximum quantity is 16, otherwise, we received too many characters */
-   rds_rtGroup       _rt_groups_rcvd[RT_GROUP_MAX_INDEX];/* RT Radio Text */
-   uint8_t           _rt_index_cycle;                    /* Seems that 5th bit of unassigned bits in block B shows if we got a full RT cycle */
-   uint8_t           _psName[PS_GROUP_MAX_CHARS];        /* PS name, eight characters max */
+   rds_rtChar        _rt_chars[RT_GROUP_MAX_CHARS];      /* RT Radio Text */
+   uint8_t           _rt_abFlag;                         /* Text A/B flag, 5th bit of unassigned bits in block B: toggles on new text */
+   bool              _rt_abKnown;                        /* At least one RT group received since reset */
+   uint8_t           _rt_size;                           /* Size of message: end of text position, or maximum of group version */
+   uint8_t           _rt_published;                      /* Size of stable prefix already published */
+   bool              _rt_complete;                       /* Full message already returned */
+   uint16_t          _rt_segments;                       /* Bit per RT segment whose characters all meet quality level */
+   rds_psChar        _psChars[PS_GROUP_MAX_CHARS];       /* PS characters being voted */
+   uint8_t           _psName[PS_GROUP_MAX_CHARS];        /* Last stable PS name, eight characters max */
+   uint8_t           _psSegments;                        /* Bit per PS segment confirmed since last character change */
+   uint8_t           _psChanges;                         /* Qty of stable PS names since station change */
+   bool              _psEvent;                           /* PS name became stable with a new value, not yet notified */
+   bool              _psDynamic;                         /* PS name changes all the time (scrolling PS) */
    uint16_t          _programIdentifer;                  /* PI  - identifies the station */
    uint8_t           _programType;                       /* PTY - identifies the station */
+   uint8_t           _trafficProgram;                    /* TP  - station carries traffic announcements */
+   uint8_t           _ptyName[PTYN_MAX_CHARS];           /* PTYN - programme type name */
+   rds_clockTime     _clockTime;                         /* CT  - last clock time received */
+   uint8_t           _rtPlusGroup;                       /* Group code of RT+ ODA, RDS_ODA_NONE if not announced */
+   rds_rtPlusTag     _rtPlusTags[RTPLUS_TAGS];           /* Last RT+ tags received */
+   uint8_t           _afList[AF_MAX_FREQS];              /* AF codes received, AF_CODE_FREQ_MIN to AF_CODE_FREQ_MAX */
+   uint8_t           _afCount;                           /* Qty of AF codes in _afList */
+   rds_stats         _stats;                             /* Reception statistics of actual station */
    RT_QUALITY_STATE  _qualityLevel;                      /* Desired quantity level of RT */
    bool              _radioText_valid;                   /* If user switched to another channel */
    bool              _verboseDecode;                     /* If we are in verbose mode */
 } rds_decoder;
 
-/*  */
+/* Block error level, BLERA-D of Si470x in RDS verbose mode. See AN230 */
+typedef enum {
+   RDS_BLER_NONE = 0x00,         /* No error */
+   RDS_BLER_1_2,                 /* 1-2 errors corrected */
+   RDS_BLER_3_5,                 /* 3-5 errors corrected */
+   RDS_BLER_UNCORRECTABLE        /* 6+ errors, block is garbage */
+} RDS_BLER;
+
+/* Confirmations given by one group to RT characters, depending on its worst block */
+#define RDS_BLER_WEIGHT_NONE       2U  /* Error free: counts as two groups */
+#define RDS_BLER_WEIGHT_CORRECTED  1U
+
+/* Blocks of one group. Receivers without error levels leave bler_x at RDS_BLER_NONE */
 typedef struct {
    uint16_t block_A;
    uint16_t block_B;
    uint16_t block_C;
    uint16_t block_D;
+   uint8_t  bler_A;   /* RDS_BLER */
+   uint8_t  bler_B;
+   uint8_t  bler_C;
+   uint8_t  bler_D;
 } rds_groupBlocks;
 
+/* Events of a batch of groups, see rdsDecoder_processGroups() */
+typedef enum {
+   RDS_EVENT_PS_CHANGED = 0x00,  /* New stable PS name, see rdsDecoder_getPS() */
+   RDS_EVENT_RT_SEGMENT,         /* Every character of an RT segment meets quality level. Value: segment */
+   RDS_EVENT_RT_COMPLETE         /* RT message complete, in rds_batchResult. Value: qty of characters */
+} RDS_EVENT;
+
+#define RDS_BATCH_MAX_EVENTS  32U  /* Events of one batch */
+#define RDS_EVENTS_PER_GROUP  3U   /* At most one event of each kind per group */
+
+typedef struct {
+   uint16_t _group;   /* Index of group in batch */
+   uint8_t  _type;    /* RDS_EVENT */
+   uint8_t  _value;
+} rds_event;
+
+typedef struct {
+   rds_event _events[RDS_BATCH_MAX_EVENTS];
+   uint8_t   _eventCount;
+   uint8_t   _rt[RT_GROUP_MAX_CHARS];       /* Message of RDS_EVENT_RT_COMPLETE, if any */
+} rds_batchResult;
+
 ///////////////////// PUBLIC FUNCTIONS DEFINITIONS /////////////////////////////
 
 /* Init decoder */
@@ -187,17 +333,45 @@ void rdsDecoder_init(RT_QUALITY_STATE wishedRTState, bool isVerbose);
  */
 void rdsDecoder_reset(void);
 
+/**
+ * @brief Forget everything about actual station (PI, PTY, PS, RT), but keep
+ * decoder configuration. Call it after each seek or tune.
+ */
+void rdsDecoder_resetStation(void);
+
 /**
  * @brief This function will sort the group, discard unnecessary data and sort 
- * important one. If full RT message is complete, it will return its size 
+ * important one. If full RT message is complete, it will return its size.
+ * Blocks with RDS_BLER_UNCORRECTABLE are rejected, error free ones need less
+ * confirmations to reach RT quality level.
  * @TODO change API to tell if we finished PS message or RT message.
  * 
+ * RT is reset when its A/B flag toggles (new text on air). It is complete once
+ * all characters up to the end of text (0x0D), or up to the maximum size, meet
+ * the quality level. A complete message is returned once.
+ * 
  * @param pointerToMsg  [out] pointer to message where to put RT message if finished
  * @param p_group       [in]  group of blocks freshly received from Si4703 to decode and sort
- * @return uint8_t      superior of 0 if message is finished, 0 if still on going
+ * @return uint8_t      qty of RT characters if message is finished, 0 if still on going
  */
 uint8_t rdsDecoder_processNewGroup(uint8_t* pointerToMsg, rds_groupBlocks *p_group);
 
+/**
+ * @brief Decode several groups in one call, typically a backlog of captured
+ * groups. What happened is reported as a list of events instead of polling
+ * decoder after each group: PS changes are consumed (rdsDecoder_getPSEvent()
+ * then returns false).
+ * Batch stops early after a group completing RT, so that its message is still
+ * in result, or when result has no room left for the events of one more group.
+ * Call it again with remaining groups.
+ * 
+ * @param groups      [in]  groups to decode, in order of reception
+ * @param groupCount  [in]  qty of groups
+ * @param result      [out] events and complete RT message
+ * @return uint16_t   qty of groups decoded
+ */
+uint16_t rdsDecoder_processGroups(const rds_groupBlocks *groups, uint16_t groupCount, rds_batchResult *result);
+
 /**
  * @brief Retrieve RT as it is. A pointer to a full RT message size is needed
  * for it as we may still not know which size has this RT message. It will only
@@ -206,20 +380,126 @@ uint8_t rdsDecoder_processNewGroup(uint8_t* pointerToMsg, rds_groupBlocks *p_gro
  * 
  * @param pointerToMsg  [in] uint8_t* pointer to an array big enough to accept mgSize chars 
  * @param wishedRTState [in] RT_QUALITY_STATE quality level to reach
- * @param msgSize       [in] uint8_t size of message to be retreived
+ * @param msgSize       [in] uint8_t qty of characters to be retrieved
  */
 void rdsDecoder_getRTMessage(uint8_t* pointerToMsg, RT_QUALITY_STATE wishedRTState, uint8_t msgSize);
 
 /**
- * @brief Get Program Station name, will return only the pointer 
- *        to rdsDecoder internal memory PS name
+ * @brief Progressive RT: get beginning of RT message which already meets the
+ * quality level, while the rest is still received. A prefix is returned only
+ * when it grew by RT_PREFIX_MIN_GROWTH characters or more, and ends on a word.
  * 
- * @param buffPS  uint8_t* pointer to PS name
- * @return true 
- * @return false 
+ * @param pointerToMsg  [out] pointer to an array of RT_GROUP_MAX_CHARS characters
+ * @return uint8_t      qty of characters of new stable prefix, 0 if nothing new to show
+ */
+uint8_t rdsDecoder_getRTPrefix(uint8_t* pointerToMsg);
+
+/**
+ * @brief Get Program Station name, copied into buffPS. It is the last stable
+ * name: all characters confirmed by votes, see PS_CONFIRM_VOTES.
+ * 
+ * @param buffPS  uint8_t* pointer to a buffer of PS_GROUP_MAX_CHARS characters
+ * @return true   if PS name is stable
+ * @return false  if PS name is not stable yet, or changing (spaces if never stable)
  */
 bool rdsDecoder_getPS(uint8_t* buffPS);
 
+/**
+ * @brief PS stable notification. Returns true once each time PS name became
+ * stable with a new value, worth a screen update.
+ * 
+ * @return true   if a new stable PS name is available with rdsDecoder_getPS()
+ */
+bool rdsDecoder_getPSEvent(void);
+
+/**
+ * @brief Check if station sends a dynamic PS (scrolling text instead of a
+ * fixed name). Such PS names are not worth saving as station name.
+ * 
+ * @return true   if stable PS name changed more than PS_DYNAMIC_CHANGES times
+ */
+bool rdsDecoder_isPSDynamic(void);
+
+/**
+ * @brief Get AF (alternative frequencies) received for actual station.
+ * Use AF_CODE_TO_MHZ() to get their frequency.
+ * 
+ * @param afList  [out] uint8_t* pointer to a buffer of AF_MAX_FREQS AF codes
+ * @return uint8_t qty of AF codes copied, 0 if none received yet
+ */
+uint8_t rdsDecoder_getAF(uint8_t* afList);
+
+/**
+ * @brief Get PI (programme identification) of actual station
+ * 
+ * @return uint16_t PI, 0x0000 if no group received yet
+ */
+uint16_t rdsDecoder_getPI(void);
+
+/**
+ * @brief Get PTY (programme type) of actual station
+ * 
+ * @return uint8_t PTY code (0 to 31)
+ */
+uint8_t rdsDecoder_getPTY(void);
+
+/**
+ * @brief Get PTYN (programme type name) of actual station
+ * 
+ * @param buffPTYN  uint8_t* pointer to a buffer of PTYN_MAX_CHARS characters
+ */
+void rdsDecoder_getPTYN(uint8_t* buffPTYN);
+
+/**
+ * @brief Get last CT (clock time and date) received
+ * 
+ * @param clockTime [out] rds_clockTime* last clock time
+ * @return true     if a CT group was received since station change
+ */
+bool rdsDecoder_getCT(rds_clockTime* clockTime);
+
+/**
+ * @brief Get RT+ tags of actual RT message
+ * 
+ * @param tags      [out] rds_rtPlusTag* pointer to RTPLUS_TAGS tags
+ * @return true     if station announced RT+ and tags were received
+ */
+bool rdsDecoder_getRTPlus(rds_rtPlusTag* tags);
+
+/**
+ * @brief Get reception statistics of actual station, counted since last
+ * station change
+ * 
+ * @param stats     [out] rds_stats* copy of statistics
+ */
+void rdsDecoder_getStats(rds_stats* stats);
+
+/////////////////////// REENTRANT FUNCTIONS /////////////////////////////////
+
+/* Same functions as above, on a decoder instance given by caller instead of the
+ * default one. Instances share nothing: each one can decode its own stream (one
+ * per station, one per capture file...), from its own thread or core. One
+ * instance must not be used by two threads at once.
+ * rdsDecoder_init_r() must be called first on each instance. */
+
+void     rdsDecoder_init_r(rds_decoder *decoder, RT_QUALITY_STATE wishedRTState, bool isVerbose);
+void     rdsDecoder_reset_r(rds_decoder *decoder);
+void     rdsDecoder_resetStation_r(rds_decoder *decoder);
+uint8_t  rdsDecoder_processNewGroup_r(rds_decoder *decoder, uint8_t* pointerToMsg, const rds_groupBlocks *p_group);
+uint16_t rdsDecoder_processGroups_r(rds_decoder *decoder, const rds_groupBlocks *groups, uint16_t groupCount, rds_batchResult *result);
+void     rdsDecoder_getRTMessage_r(const rds_decoder *decoder, uint8_t* pointerToMsg, RT_QUALITY_STATE wishedRTState, uint8_t msgSize);
+uint8_t  rdsDecoder_getRTPrefix_r(rds_decoder *decoder, uint8_t* pointerToMsg);
+bool     rdsDecoder_getPS_r(const rds_decoder *decoder, uint8_t* buffPS);
+bool     rdsDecoder_getPSEvent_r(rds_decoder *decoder);
+bool     rdsDecoder_isPSDynamic_r(const rds_decoder *decoder);
+uint8_t  rdsDecoder_getAF_r(const rds_decoder *decoder, uint8_t* afList);
+uint16_t rdsDecoder_getPI_r(const rds_decoder *decoder);
+uint8_t  rdsDecoder_getPTY_r(const rds_decoder *decoder);
+void     rdsDecoder_getPTYN_r(const rds_decoder *decoder, uint8_t* buffPTYN);
+bool     rdsDecoder_getCT_r(const rds_decoder *decoder, rds_clockTime* clockTime);
+bool     rdsDecoder_getRTPlus_r(const rds_decoder *decoder, rds_rtPlusTag* tags);
+void     rdsDecoder_getStats_r(const rds_decoder *decoder, rds_stats* stats);
+
 #ifdef __cplusplus
 }
 #endif
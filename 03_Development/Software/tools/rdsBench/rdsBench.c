@@ -0,0 +1,382 @@
+/**
+ * @file    rdsBench.c
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Benchmark and convergence metrics of rdsDecoder, on the host.
+ *
+ *          A synthetic station (PI, PS name, RT message) is put on air: 0A and
+ *          2A groups, plus groups decoder does not handle, at 11.4 groups per
+ *          second as on air. A channel model corrupts it, per block:
+ *             - error rate: a block is hit. Si470x then corrects it (BLER 1-2,
+ *               data intact), miscorrects it (BLER 3-5, bits flipped) or
+ *               flags it uncorrectable (random data), see BENCH_ERR_*
+ *             - drop rate: a whole group is lost (GPIO2 missed, main loop late)
+ *          For each RT_STATE_QUALITY level and error rate, several trials
+ *          report:
+ *             - groups and seconds on air to a correct PS name, to a complete RT
+ *             - wrong PS names and RT messages reported by decoder
+ *          Then raw decode throughput, in groups per second: one group per
+ *          call, then by batches (rdsDecoder_processGroups_r). Decoder is a
+ *          local instance of the reentrant API, as on core1.
+ *
+ *             rdsBench [-n trials] [-e error rate] [-d drop rate] [-s seed]
+ *          Without -e, a sweep of error rates is done.
+ * @version 0.1
+ * @date    2023-09-23
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include "rdsDecoder.h"
+
+#define BENCH_GROUP_MS          87.7    /* 104 bits at 1187.5 bit/s */
+#define BENCH_MAX_GROUPS        3000U   /* ~4 minutes on air, trial failed after it */
+#define BENCH_TRIALS            200U
+#define BENCH_THROUGHPUT_GROUPS 2000896UL  /* Multiple of BENCH_BATCH_GROUPS */
+#define BENCH_BATCH_GROUPS      1024U
+#define BENCH_ERR_CORRECTED     50U     /* % of hit blocks corrected by Si470x */
+#define BENCH_ERR_MISCORRECTED  10U     /* % of hit blocks miscorrected, rest is uncorrectable */
+
+#define BENCH_PI                0xD318
+#define BENCH_PS                "RADIO 1 "
+#define BENCH_RT                "Now playing: The Artist - A Song Title Long Enough\r"
+/* Last RT group is padded with spaces */
+#define BENCH_RT_CHAR(rt, index) (((index) < (sizeof(rt) - 1U)) ? (uint8_t)(rt)[(index)] : 0x20U)
+
+/**
+ * @brief Results of one trial
+ */
+typedef struct {
+   uint32_t _groupsToPS;    /* Groups sent until correct PS, BENCH_MAX_GROUPS if never */
+   uint32_t _groupsToRT;    /* Groups sent until correct complete RT, BENCH_MAX_GROUPS if never */
+   uint32_t _wrongPS;       /* Stable PS names different from the one on air */
+   uint32_t _wrongRT;       /* Complete RT messages different from the one on air */
+} bench_trial;
+
+/**
+ * @brief Sum of trials of one configuration
+ */
+typedef struct {
+   uint64_t _groupsToPS;
+   uint64_t _groupsToRT;
+   uint32_t _failedPS;
+   uint32_t _failedRT;
+   uint32_t _wrongPS;
+   uint32_t _wrongRT;
+   uint32_t _trials;
+} bench_result;
+
+static uint32_t    _rngState;
+static rds_decoder _decoder;   /* Decoder under test, reinitialized for each quality level */
+
+/**
+ * @brief Pseudo random generator, reproducible with -s
+ */
+static uint32_t bench_random(void)
+{
+   _rngState ^= _rngState << 13;
+   _rngState ^= _rngState >> 17;
+   _rngState ^= _rngState << 5;
+   return _rngState;
+}
+
+/**
+ * @brief true with a probability in [0, 1]
+ */
+static bool bench_chance(double probability)
+{
+   return ((double)(bench_random() & 0xFFFFFF) < (probability * (double)0x1000000));
+}
+
+/**
+ * @brief Group number index of station cycle, as a broadcaster would send it
+ */
+static void bench_makeGroup(uint32_t index, rds_groupBlocks *group);
+
+/**
+ * @brief Corrupt one block as Si470x would report it
+ */
+static void bench_corruptBlock(uint16_t *block, uint8_t *bler, double errorRate);
+
+/**
+ * @brief Run one trial, decoder reset before
+ */
+static void bench_trialRun(double errorRate, double dropRate, bench_trial *trial);
+
+/**
+ * @brief Decode groups without errors, as fast as possible, one by one or by
+ * batches (rdsDecoder_processGroups)
+ * @return groups per second
+ */
+static double bench_throughput(bool batch);
+
+static void bench_printHeader(void)
+{
+   printf("%-7s %7s %7s | %9s %8s %6s %6s | %9s %8s %6s %6s\n", "quality", "err%", "drop%",
+          "groupsPS", "sPS", "fail", "wrong", "groupsRT", "sRT", "fail", "wrong");
+}
+
+static void bench_printResult(RT_QUALITY_STATE quality, double errorRate, double dropRate, const bench_result *result)
+{
+   uint32_t okPS = result->_trials - result->_failedPS;
+   uint32_t okRT = result->_trials - result->_failedRT;
+   double   groupsPS = (0 < okPS) ? ((double)result->_groupsToPS / okPS) : 0.0;
+   double   groupsRT = (0 < okRT) ? ((double)result->_groupsToRT / okRT) : 0.0;
+
+   printf("%-7d %7.1f %7.1f | %9.1f %8.2f %6u %6u | %9.1f %8.2f %6u %6u\n", (int)quality,
+          errorRate * 100.0, dropRate * 100.0,
+          groupsPS, groupsPS * BENCH_GROUP_MS / 1000.0, result->_failedPS, result->_wrongPS,
+          groupsRT, groupsRT * BENCH_GROUP_MS / 1000.0, result->_failedRT, result->_wrongRT);
+}
+
+int main(int argc, char *argv[])
+{
+   static const double sweep[] = {0.0, 0.01, 0.05, 0.10, 0.20, 0.30};
+   double   errorRates[sizeof(sweep) / sizeof(sweep[0])];
+   uint8_t  errorRatesCount = 0;
+   double   dropRate  = 0.0;
+   uint32_t trials    = BENCH_TRIALS;
+   uint32_t seed      = 0x12345678;
+   uint32_t index     = 0;
+   uint8_t  rateIndex = 0;
+   int      quality   = 0;
+   int      option    = 0;
+   int      retVal    = 0;
+   bench_trial  trial;
+   bench_result result;
+
+   while(-1 != (option = getopt(argc, argv, "n:e:d:s:")))
+   {
+      switch(option)
+      {
+         case 'n':
+            trials = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+         case 'e':
+            errorRates[0]   = atof(optarg);
+            errorRatesCount = 1;
+            break;
+         case 'd':
+            dropRate = atof(optarg);
+            break;
+         case 's':
+            seed = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+         default:
+            retVal = 2;
+            break;
+      }
+   }
+
+   if((0 != retVal) || (0 == trials) || (0 == seed))
+   {
+      fprintf(stderr, "Usage: %s [-n trials] [-e error rate 0..1] [-d drop rate 0..1] [-s seed, not 0]\n", argv[0]);
+      retVal = 2;
+   }
+   else
+   {
+      if(0 == errorRatesCount)
+      {
+         memcpy(&errorRates[0], &sweep[0], sizeof(sweep));
+         errorRatesCount = sizeof(sweep) / sizeof(sweep[0]);
+      }
+
+      printf("%u trials per line, drop rate %.1f %%, %.1f ms per group\n", trials, dropRate * 100.0, BENCH_GROUP_MS);
+      bench_printHeader();
+      for(quality = RT_STATE_QUALITY_BAD; quality <= RT_STATE_QUALITY_GOOD; quality++)
+      {
+         for(rateIndex = 0; rateIndex < errorRatesCount; rateIndex++)
+         {
+            /* Same channel for every quality level: numbers are comparable */
+            _rngState = seed;
+            memset(&result, 0, sizeof(result));
+            rdsDecoder_init_r(&_decoder, (RT_QUALITY_STATE)quality, false);
+            for(index = 0; index < trials; index++)
+            {
+               rdsDecoder_resetStation_r(&_decoder);
+               bench_trialRun(errorRates[rateIndex], dropRate, &trial);
+               result._groupsToPS += (BENCH_MAX_GROUPS > trial._groupsToPS) ? trial._groupsToPS : 0;
+               result._groupsToRT += (BENCH_MAX_GROUPS > trial._groupsToRT) ? trial._groupsToRT : 0;
+               result._failedPS   += (BENCH_MAX_GROUPS > trial._groupsToPS) ? 0 : 1;
+               result._failedRT   += (BENCH_MAX_GROUPS > trial._groupsToRT) ? 0 : 1;
+               result._wrongPS    += trial._wrongPS;
+               result._wrongRT    += trial._wrongRT;
+               result._trials++;
+            }
+            bench_printResult((RT_QUALITY_STATE)quality, errorRates[rateIndex], dropRate, &result);
+         }
+      }
+
+      printf("Throughput: %.0f groups/s, %.0f groups/s by batches of %u\n", bench_throughput(false),
+             bench_throughput(true), BENCH_BATCH_GROUPS);
+   }
+   return retVal;
+}
+
+static void bench_makeGroup(uint32_t index, rds_groupBlocks *group)
+{
+   static const char ps[] = BENCH_PS;
+   static const char rt[] = BENCH_RT;
+   /* Broadcasters send PS and RT most of the time, and other groups in between */
+   uint32_t slot    = index % 5U;
+   uint32_t cycle   = index / 5U;
+   uint32_t segment = 0;
+
+   memset(group, 0, sizeof(*group));
+   group->block_A = BENCH_PI;
+
+   if((0 == slot) || (2 == slot))
+   {
+      /* 0A: PS name, 2 characters per group. Block C: AF codes 87.6 and 89.2 MHz */
+      segment = ((cycle * 2U) + (slot / 2U)) % 4U;
+      group->block_B = (uint16_t)(0x0000 | segment);
+      group->block_C = 0x0111;
+      group->block_D = (uint16_t)((ps[2U * segment] << 8) | ps[(2U * segment) + 1U]);
+   }
+   else if((1 == slot) || (3 == slot))
+   {
+      /* 2A: RT, 4 characters per group, text A */
+      segment = ((cycle * 2U) + (slot / 2U)) % ((sizeof(rt) - 1U + 3U) / 4U);
+      group->block_B = (uint16_t)(0x2000 | segment);
+      group->block_C = (uint16_t)((BENCH_RT_CHAR(rt, 4U * segment) << 8) | BENCH_RT_CHAR(rt, (4U * segment) + 1U));
+      group->block_D = (uint16_t)((BENCH_RT_CHAR(rt, (4U * segment) + 2U) << 8) | BENCH_RT_CHAR(rt, (4U * segment) + 3U));
+   }
+   else
+   {
+      /* 8A (TMC), not decoded: dispatch cost only */
+      group->block_B = 0x8000;
+      group->block_C = (uint16_t)bench_random();
+      group->block_D = (uint16_t)bench_random();
+   }
+}
+
+static void bench_corruptBlock(uint16_t *block, uint8_t *bler, double errorRate)
+{
+   uint32_t kind = 0;
+
+   if(true == bench_chance(errorRate))
+   {
+      kind = bench_random() % 100U;
+      if(BENCH_ERR_CORRECTED > kind)
+      {
+         *bler = RDS_BLER_1_2;
+      }
+      else if((BENCH_ERR_CORRECTED + BENCH_ERR_MISCORRECTED) > kind)
+      {
+         *bler   = RDS_BLER_3_5;
+         *block ^= (uint16_t)(1U << (bench_random() % 16U));
+      }
+      else
+      {
+         *bler  = RDS_BLER_UNCORRECTABLE;
+         *block = (uint16_t)bench_random();
+      }
+   }
+}
+
+static void bench_trialRun(double errorRate, double dropRate, bench_trial *trial)
+{
+   static const char ps[] = BENCH_PS;
+   static const char rt[] = BENCH_RT;
+   rds_groupBlocks group;
+   uint8_t  rtMsg[RT_GROUP_MAX_CHARS];
+   uint8_t  psName[PS_GROUP_MAX_CHARS];
+   uint8_t  sizeOfRTmsg = 0;
+   uint32_t index  = 0;
+   /* Station is tuned anywhere in its cycle */
+   uint32_t offset = bench_random() % 100U;
+
+   trial->_groupsToPS = BENCH_MAX_GROUPS;
+   trial->_groupsToRT = BENCH_MAX_GROUPS;
+   trial->_wrongPS    = 0;
+   trial->_wrongRT    = 0;
+
+   for(index = 0; (index < BENCH_MAX_GROUPS)
+               && ((BENCH_MAX_GROUPS == trial->_groupsToPS) || (BENCH_MAX_GROUPS == trial->_groupsToRT)); index++)
+   {
+      bench_makeGroup(index + offset, &group);
+      if(false == bench_chance(dropRate))
+      {
+         bench_corruptBlock(&group.block_A, &group.bler_A, errorRate);
+         bench_corruptBlock(&group.block_B, &group.bler_B, errorRate);
+         bench_corruptBlock(&group.block_C, &group.bler_C, errorRate);
+         bench_corruptBlock(&group.block_D, &group.bler_D, errorRate);
+
+         sizeOfRTmsg = rdsDecoder_processNewGroup_r(&_decoder, &rtMsg[0], &group);
+
+         if(true == rdsDecoder_getPSEvent_r(&_decoder))
+         {
+            rdsDecoder_getPS_r(&_decoder, &psName[0]);
+            if(0 != memcmp(&psName[0], &ps[0], PS_GROUP_MAX_CHARS))
+            {
+               trial->_wrongPS++;
+            }
+            else if(BENCH_MAX_GROUPS == trial->_groupsToPS)
+            {
+               trial->_groupsToPS = index + 1U;
+            }
+         }
+
+         if(0 < sizeOfRTmsg)
+         {
+            /* RT on air ends with 0x0D, not reported by decoder */
+            if((sizeOfRTmsg != (sizeof(rt) - 2U)) || (0 != memcmp(&rtMsg[0], &rt[0], sizeOfRTmsg)))
+            {
+               trial->_wrongRT++;
+            }
+            else if(BENCH_MAX_GROUPS == trial->_groupsToRT)
+            {
+               trial->_groupsToRT = index + 1U;
+            }
+         }
+      }
+   }
+}
+
+static double bench_throughput(bool batch)
+{
+   static rds_groupBlocks groups[BENCH_BATCH_GROUPS];
+   rds_batchResult result;
+   uint8_t  rtMsg[RT_GROUP_MAX_CHARS];
+   uint32_t index = 0;
+   uint32_t done  = 0;
+   struct timespec start;
+   struct timespec end;
+   double   seconds = 0.0;
+
+   for(index = 0; index < BENCH_BATCH_GROUPS; index++)
+   {
+      bench_makeGroup(index, &groups[index]);
+   }
+
+   rdsDecoder_init_r(&_decoder, RT_STATE_QUALITY_BAD, false);
+   clock_gettime(CLOCK_MONOTONIC, &start);
+   for(index = 0; index < BENCH_THROUGHPUT_GROUPS; index += BENCH_BATCH_GROUPS)
+   {
+      /* Decoder modifies nothing in groups, copies are not needed */
+      for(done = 0; done < BENCH_BATCH_GROUPS;)
+      {
+         if(true == batch)
+         {
+            done += rdsDecoder_processGroups_r(&_decoder, &groups[done], (uint16_t)(BENCH_BATCH_GROUPS - done), &result);
+         }
+         else
+         {
+            rdsDecoder_processNewGroup_r(&_decoder, &rtMsg[0], &groups[done]);
+            (void)rdsDecoder_getPSEvent_r(&_decoder);
+            done++;
+         }
+      }
+   }
+   clock_gettime(CLOCK_MONOTONIC, &end);
+
+   seconds = (double)(end.tv_sec - start.tv_sec) + ((double)(end.tv_nsec - start.tv_nsec) / 1e9);
+   return (double)BENCH_THROUGHPUT_GROUPS / seconds;
+}
@@ -0,0 +1,272 @@
+/**
+ * @file    rdsReplay.c
+ * @author  Kureciplatek (galleej@gmail.com)
+ * @brief   Host replay of RDS captures through rdsDecoder, same sources as
+ *          the radio. See rdsCapture.h for the capture format.
+ *
+ *          Replay a capture, at maximum speed or in real time (-r):
+ *             rdsReplay [-r] [-q quality] [-v] capture.rdsc
+ *          Convert a UART log of the radio (built with FM_RDS_RECORDER):
+ *             rdsReplay -i uart.log -o capture.rdsc
+ *
+ *          quality is the RT_QUALITY_STATE of decoder: 1 bad (default, as
+ *          on the radio), 2 middle, 3 good.
+ * @version 0.1
+ * @date    2023-09-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include "rdsDecoder.h"
+#include "rdsCapture.h"
+
+#define REPLAY_LINE_MAX   256U
+
+/**
+ * @brief Convert a UART log into a capture file
+ * @return qty of records written, -1 if a file can't be opened
+ */
+static long replay_import(const char *logPath, const char *capturePath);
+
+/**
+ * @brief Decode a capture file
+ * @return 0 if capture was read, 1 otherwise
+ */
+static int replay_run(const char *capturePath, RT_QUALITY_STATE quality, bool realTime, bool verbose);
+
+/**
+ * @brief Monotonic time in ns
+ */
+static uint64_t replay_nowNs(void);
+
+/**
+ * @brief Wait for a number of ms
+ */
+static void replay_sleepMs(uint32_t ms);
+
+static void replay_usage(const char *name)
+{
+   fprintf(stderr, "Usage: %s [-r] [-q 1..3] [-v] capture.rdsc\n", name);
+   fprintf(stderr, "       %s -i uart.log -o capture.rdsc\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+   const char      *logPath     = NULL;
+   const char      *outputPath  = NULL;
+   RT_QUALITY_STATE quality     = RT_STATE_QUALITY_BAD;
+   bool             realTime    = false;
+   bool             verbose     = false;
+   long             records     = 0;
+   int              option      = 0;
+   int              retVal      = 0;
+
+   while(-1 != (option = getopt(argc, argv, "rq:vi:o:")))
+   {
+      switch(option)
+      {
+         case 'r':
+            realTime = true;
+            break;
+         case 'q':
+            quality = (RT_QUALITY_STATE)atoi(optarg);
+            break;
+         case 'v':
+            verbose = true;
+            break;
+         case 'i':
+            logPath = optarg;
+            break;
+         case 'o':
+            outputPath = optarg;
+            break;
+         default:
+            retVal = 2;
+            break;
+      }
+   }
+
+   if((0 == retVal) && (NULL != logPath) && (NULL != outputPath))
+   {
+      records = replay_import(logPath, outputPath);
+      if(0 <= records)
+      {
+         printf("%ld records written to %s\n", records, outputPath);
+      }
+      retVal = (0 <= records) ? 0 : 1;
+   }
+   else if((0 == retVal) && (NULL == logPath) && (NULL == outputPath) && (optind < argc)
+        && (RT_STATE_QUALITY_BAD <= quality) && (RT_STATE_QUALITY_GOOD >= quality))
+   {
+      retVal = replay_run(argv[optind], quality, realTime, verbose);
+   }
+   else
+   {
+      replay_usage(argv[0]);
+      retVal = 2;
+   }
+   return retVal;
+}
+
+static long replay_import(const char *logPath, const char *capturePath)
+{
+   FILE   *logFile     = fopen(logPath, "r");
+   FILE   *captureFile = fopen(capturePath, "wb");
+   char    line[REPLAY_LINE_MAX];
+   uint8_t buffer[RDS_CAPTURE_RECORD_SIZE];
+   rds_captureRecord record;
+   long    records = -1;
+
+   if((NULL != logFile) && (NULL != captureFile))
+   {
+      records = 0;
+      rdsCapture_writeHeader(&buffer[0]);
+      fwrite(&buffer[0], 1, RDS_CAPTURE_HEADER_SIZE, captureFile);
+
+      /* Log lines of the radio are skipped */
+      while(NULL != fgets(&line[0], sizeof(line), logFile))
+      {
+         if(true == rdsCapture_fromLine(&line[0], &record))
+         {
+            rdsCapture_encode(&buffer[0], &record);
+            fwrite(&buffer[0], 1, RDS_CAPTURE_RECORD_SIZE, captureFile);
+            records++;
+         }
+      }
+   }
+   else
+   {
+      fprintf(stderr, "Can't open %s or %s\n", logPath, capturePath);
+   }
+
+   if(NULL != logFile)
+   {
+      fclose(logFile);
+   }
+   if(NULL != captureFile)
+   {
+      fclose(captureFile);
+   }
+   return records;
+}
+
+static int replay_run(const char *capturePath, RT_QUALITY_STATE quality, bool realTime, bool verbose)
+{
+   FILE    *captureFile = fopen(capturePath, "rb");
+   uint8_t  buffer[RDS_CAPTURE_RECORD_SIZE];
+   uint8_t  rtMsg[RT_GROUP_MAX_CHARS];
+   uint8_t  psName[PS_GROUP_MAX_CHARS];
+   uint8_t  sizeOfRTmsg = 0x00;
+   uint16_t pi          = 0x0000;
+   uint32_t firstMs     = 0x00;
+   uint32_t lastMs      = 0x00;
+   uint64_t decodeNs    = 0x00;
+   uint64_t startNs     = 0x00;
+   unsigned long groups = 0;
+   rds_captureRecord record;
+   rds_stats stats;
+   int      retVal = 1;
+
+   if(NULL == captureFile)
+   {
+      fprintf(stderr, "Can't open %s\n", capturePath);
+   }
+   else if((RDS_CAPTURE_HEADER_SIZE != fread(&buffer[0], 1, RDS_CAPTURE_HEADER_SIZE, captureFile))
+        || (false == rdsCapture_checkHeader(&buffer[0])))
+   {
+      fprintf(stderr, "%s is not an RDS capture\n", capturePath);
+   }
+   else
+   {
+      retVal = 0;
+      rdsDecoder_init(quality, verbose);
+
+      while(RDS_CAPTURE_RECORD_SIZE == fread(&buffer[0], 1, RDS_CAPTURE_RECORD_SIZE, captureFile))
+      {
+         rdsCapture_decode(&buffer[0], &record);
+         if(0 == groups)
+         {
+            firstMs = record._timeMs;
+         }
+         else if((true == realTime) && (record._timeMs > lastMs))
+         {
+            replay_sleepMs(record._timeMs - lastMs);
+         }
+         lastMs = record._timeMs;
+
+         if(0x00 != (record._flags & RDS_CAPTURE_FLAG_NEW_STATION))
+         {
+            printf("[%8lu ms] New station, RSSI %u\n", (unsigned long)(record._timeMs - firstMs), record._rssi);
+            rdsDecoder_resetStation();
+            pi = 0x0000;
+         }
+
+         startNs      = replay_nowNs();
+         sizeOfRTmsg  = rdsDecoder_processNewGroup(&rtMsg[0], &record._group);
+         decodeNs    += replay_nowNs() - startNs;
+         groups++;
+
+         if(pi != rdsDecoder_getPI())
+         {
+            pi = rdsDecoder_getPI();
+            printf("[%8lu ms] PI 0x%04X\n", (unsigned long)(record._timeMs - firstMs), pi);
+         }
+         if(true == rdsDecoder_getPSEvent())
+         {
+            rdsDecoder_getPS(&psName[0]);
+            printf("[%8lu ms] PS \"%.*s\"%s\n", (unsigned long)(record._timeMs - firstMs), (int)PS_GROUP_MAX_CHARS,
+                   (const char *)&psName[0], (true == rdsDecoder_isPSDynamic()) ? " (dynamic)" : "");
+         }
+         if(0 < sizeOfRTmsg)
+         {
+            printf("[%8lu ms] RT \"%.*s\"\n", (unsigned long)(record._timeMs - firstMs), (int)sizeOfRTmsg, (const char *)&rtMsg[0]);
+         }
+         else
+         {
+            sizeOfRTmsg = rdsDecoder_getRTPrefix(&rtMsg[0]);
+            if(0 < sizeOfRTmsg)
+            {
+               printf("[%8lu ms] RT prefix \"%.*s\"\n", (unsigned long)(record._timeMs - firstMs), (int)sizeOfRTmsg, (const char *)&rtMsg[0]);
+            }
+         }
+      }
+
+      printf("%lu groups, %lu ms on air, %.1f us of decoding per group\n", groups,
+             (unsigned long)(lastMs - firstMs), (0 < groups) ? ((double)decodeNs / 1000.0 / (double)groups) : 0.0);
+      /* Statistics restart with each station: last one only */
+      rdsDecoder_getStats(&stats);
+      printf("Last station: %lu discarded (block B), %lu unhandled, %lu TP, uncorrectable blocks A %lu B %lu C %lu D %lu\n",
+             (unsigned long)stats._discarded, (unsigned long)stats._unhandled, (unsigned long)stats._tpGroups,
+             (unsigned long)stats._bler[0][RDS_BLER_UNCORRECTABLE], (unsigned long)stats._bler[1][RDS_BLER_UNCORRECTABLE],
+             (unsigned long)stats._bler[2][RDS_BLER_UNCORRECTABLE], (unsigned long)stats._bler[3][RDS_BLER_UNCORRECTABLE]);
+   }
+
+   if(NULL != captureFile)
+   {
+      fclose(captureFile);
+   }
+   return retVal;
+}
+
+static uint64_t replay_nowNs(void)
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+}
+
+static void replay_sleepMs(uint32_t ms)
+{
+   struct timespec wait = {(time_t)(ms / 1000U), (long)((ms % 1000U) * 1000000UL)};
+
+   nanosleep(&wait, NULL);
+}